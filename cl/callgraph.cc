@@ -25,6 +25,12 @@
 #include <cl/storage.hh>
 
 #include "stopwatch.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
 
 #include <boost/foreach.hpp>
 
@@ -118,6 +124,107 @@ void handleFnc(Fnc *const fnc)
     }
 }
 
+// Tarjan's algorithm (with an explicit stack, so that a deep call graph cannot
+// overflow the stack of the analyser), we only need to know which functions
+// are recursive, i.e. belong to a non-trivial SCC
+struct RecursionFinder {
+    typedef std::map<const Node *, int>             TIndex;
+    typedef TInsnListByFnc::const_iterator          TCallIter;
+    typedef std::pair<Node *, TCallIter>            TFrame;
+
+    TIndex                          index;
+    TIndex                          lowLink;
+    std::vector<Node *>             stack;
+    std::set<const Node *>          onStack;
+    std::vector<TFrame>             todo;
+
+    void enter(Node *node);
+    void leave(Node *node);
+    void visit(Node *root);
+};
+
+void RecursionFinder::enter(Node *node)
+{
+    const int idx = this->index.size();
+    this->index[node] = idx;
+    this->lowLink[node] = idx;
+    this->stack.push_back(node);
+    this->onStack.insert(node);
+    this->todo.push_back(TFrame(node, node->calls.begin()));
+}
+
+void RecursionFinder::leave(Node *node)
+{
+    if (this->lowLink[node] != this->index[node])
+        // not a root of SCC
+        return;
+
+    // pop the SCC from the stack
+    std::vector<Node *> scc;
+    Node *top;
+    do {
+        top = this->stack.back();
+        this->stack.pop_back();
+        this->onStack.erase(top);
+        scc.push_back(top);
+    }
+    while (top != node);
+
+    // a single node is recursive only if it calls itself
+    if (scc.size() < 2U && !hasKey(node->calls, node->fnc))
+        return;
+
+    BOOST_FOREACH(Node *member, scc)
+        member->recursive = true;
+}
+
+void RecursionFinder::visit(Node *root)
+{
+    this->enter(root);
+
+    while (!this->todo.empty()) {
+        TFrame &frame = this->todo.back();
+        Node *const node = frame.first;
+
+        if (node->calls.end() == frame.second) {
+            // all callees of node processed
+            this->todo.pop_back();
+            this->leave(node);
+            if (this->todo.empty())
+                break;
+
+            Node *const caller = this->todo.back().first;
+            this->lowLink[caller] = std::min(this->lowLink[caller],
+                                             this->lowLink[node]);
+            continue;
+        }
+
+        const Fnc *callee = (frame.second++)->first;
+        if (!callee)
+            // indirect call
+            continue;
+
+        Node *const target = callee->cgNode;
+        if (!hasKey(this->index, target))
+            // invalidates frame
+            this->enter(target);
+        else if (hasKey(this->onStack, target))
+            this->lowLink[node] = std::min(this->lowLink[node],
+                                           this->index[target]);
+    }
+}
+
+void findRecursion(const Storage &stor)
+{
+    RecursionFinder finder;
+
+    BOOST_FOREACH(const Fnc *fnc, stor.fncs) {
+        Node *const node = fnc->cgNode;
+        if (node && !hasKey(finder.index, node))
+            finder.visit(node);
+    }
+}
+
 void buildCallGraph(const Storage &stor)
 {
     StopWatch watch;
@@ -132,6 +239,8 @@ void buildCallGraph(const Storage &stor)
             BOOST_FOREACH(const TOp op, insn->operands)
                 handleCallback(cg, /* node */ 0, insn, op);
 
+    findRecursion(stor);
+
     CL_DEBUG("buildCallGraph() took " << watch);
 }
 
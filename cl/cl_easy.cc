@@ -64,6 +64,12 @@ class ClEasy: public ClStorageBuilder {
             CL_DEBUG("scanning CFG for loop-closing edges...");
             findLoopClosingEdges(stor);
 
+            CL_DEBUG("looking for blocks whose states need to be retained...");
+            findRetainedStates(stor);
+
+            CL_DEBUG("collecting integral constants for widening...");
+            findIntThresholds(stor);
+
             CL_DEBUG("killing local variables...");
             killLocalVariables(stor);
 
@@ -26,6 +26,8 @@
 #include "util.hh"
 #include "stopwatch.hh"
 
+#include <algorithm>
+#include <climits>
 #include <set>
 #include <stack>
 
@@ -141,6 +143,69 @@ void analyzeFnc(Fnc &fnc)
     }
 }
 
+void markRetainedStates(Fnc &fnc)
+{
+    // collect blocks reachable from the entry
+    TBlockSet reach;
+    std::stack<TBlock> todo;
+    todo.push(fnc.cfg.entry());
+    while (!todo.empty()) {
+        const TBlock bb = todo.top();
+        todo.pop();
+        if (!insertOnce(reach, bb))
+            continue;
+
+        BOOST_FOREACH(const TBlock bbNext, bb->targets())
+            todo.push(bbNext);
+    }
+
+    BOOST_FOREACH(const TBlock bb, reach) {
+        // the fixed-point computation needs the state of each loop entry
+        bool retain = bb->isLoopEntry();
+        if (!retain) {
+            // heaps coming along distinct reachable paths meet at join points
+            // (the dominance frontier of their predecessors), which is where
+            // the join of heaps pays off
+            TBlockSet preds;
+            BOOST_FOREACH(const TBlock bbPred, bb->inbound())
+                if (hasKey(reach, bbPred))
+                    preds.insert(bbPred);
+
+            retain = (1U < preds.size());
+        }
+
+        if (!retain)
+            continue;
+
+        LS_DEBUG(2, "state of " << bb->name() << " in " << nameOf(fnc)
+                << "() is retained");
+
+        const_cast<Block *>(bb)->setStateRetained();
+    }
+}
+
+void collectIntConsts(std::vector<long> &dst, const Insn *insn)
+{
+    BOOST_FOREACH(const struct cl_operand &op, insn->operands) {
+        if (CL_OPERAND_CST != op.code)
+            continue;
+
+        const enum cl_type_e code = op.data.cst.code;
+        if (CL_TYPE_INT != code && CL_TYPE_ENUM != code)
+            continue;
+
+        // c - 1 and c + 1 cover both strict and non-strict bounds
+        const long c = op.data.cst.data.cst_int.value;
+        if (LONG_MIN < c)
+            dst.push_back(c - 1);
+
+        dst.push_back(c);
+
+        if (c < LONG_MAX)
+            dst.push_back(c + 1);
+    }
+}
+
 } // namespace LoopScan
 
 void findLoopClosingEdges(Storage &stor)
@@ -161,4 +226,44 @@ void findLoopClosingEdges(Storage &stor)
     CL_DEBUG("findLoopClosingEdges() took " << watch);
 }
 
+void findRetainedStates(Storage &stor)
+{
+    StopWatch watch;
+
+    BOOST_FOREACH(Fnc *pFnc, stor.fncs) {
+        Fnc &fnc = *pFnc;
+        if (isDefined(fnc))
+            LoopScan::markRetainedStates(fnc);
+    }
+
+    CL_DEBUG("findRetainedStates() took " << watch);
+}
+
+void findIntThresholds(Storage &stor)
+{
+    StopWatch watch;
+    std::vector<long> &thr = stor.intThresholds;
+    thr.clear();
+
+    // initializers of variables
+    BOOST_FOREACH(const Var &var, stor.vars)
+        BOOST_FOREACH(const Insn *insn, var.initials)
+            LoopScan::collectIntConsts(thr, insn);
+
+    // bodies of defined functions
+    BOOST_FOREACH(const Fnc *pFnc, stor.fncs) {
+        if (!isDefined(*pFnc))
+            continue;
+
+        BOOST_FOREACH(const Block *bb, pFnc->cfg)
+            BOOST_FOREACH(const Insn *insn, *bb)
+                LoopScan::collectIntConsts(thr, insn);
+    }
+
+    std::sort(thr.begin(), thr.end());
+    thr.erase(std::unique(thr.begin(), thr.end()), thr.end());
+
+    CL_DEBUG("findIntThresholds() took " << watch);
+}
+
 } // namespace CodeStorage
@@ -29,6 +29,18 @@ namespace CodeStorage {
     struct Storage;
 
     void findLoopClosingEdges(Storage &stor);
+
+    /**
+     * mark blocks the entry state of which needs to be retained by the analysis
+     * @note needs to be called after findLoopClosingEdges()
+     */
+    void findRetainedStates(Storage &stor);
+
+    /**
+     * collect integral constants used in the program (including initializers
+     * of variables) as thresholds for widening, see Storage::intThresholds
+     */
+    void findIntThresholds(Storage &stor);
 }
 
 #endif /* H_GUARD_LOOPSCAN_H */
@@ -25,8 +25,10 @@
 #include "cl_storage.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <map>
 #include <stack>
+#include <vector>
 
 #include <boost/foreach.hpp>
 #include <boost/tuple/tuple.hpp>
@@ -77,6 +79,98 @@ namespace {
 
         return idxTab[iter->second];
     }
+
+    /**
+     * Mapping from uid to index, direct-indexed by uid as long as the uids are
+     * reasonably dense, std::map is used as a fallback for the outliers (e.g.
+     * the artificial variables created by clf_unswitch).
+     */
+    class UidMap {
+        public:
+            UidMap():
+                cnt_(0U)
+            {
+            }
+
+            bool find(unsigned *pIdx, const int uid) const {
+                if (0 <= uid && static_cast<unsigned>(uid) < dense_.size()) {
+                    const unsigned slot = dense_[uid];
+                    if (slot) {
+                        *pIdx = slot - 1U;
+                        return true;
+                    }
+                }
+
+                if (sparse_.empty())
+                    return false;
+
+                const TSparse::const_iterator iter = sparse_.find(uid);
+                if (sparse_.end() == iter)
+                    return false;
+
+                *pIdx = iter->second;
+                return true;
+            }
+
+            void insert(const int uid, const unsigned idx) {
+                ++cnt_;
+                if (uid < 0 || densityLimit() < static_cast<unsigned>(uid)) {
+                    sparse_[uid] = idx;
+                    return;
+                }
+
+                const size_t pos = uid;
+                if (dense_.size() <= pos)
+                    dense_.resize(std::max(pos + 1U, 2U * dense_.size()), 0U);
+
+                dense_[pos] = idx + 1U;
+            }
+
+        private:
+            typedef std::map<int, unsigned> TSparse;
+
+            /// largest uid stored directly, given the count of items so far
+            unsigned densityLimit() const {
+                return 0x10000U + 0x10U * cnt_;
+            }
+
+            std::vector<unsigned>   dense_;     ///< index + 1, 0 if missing
+            TSparse                 sparse_;
+            unsigned                cnt_;
+    };
+
+    /// dbLookup() specialized for UidMap
+    template <class TTab>
+    typename TTab::value_type&
+    dbLookup(UidMap &db, TTab &idxTab, const int uid,
+             const typename TTab::value_type &tpl
+                 = typename TTab::value_type())
+    {
+        unsigned idx;
+        if (db.find(&idx, uid))
+            // uid found
+            return idxTab[idx];
+
+        // allocate a new item
+        idx = idxTab.size();
+        db.insert(uid, idx);
+        idxTab.push_back(tpl);
+        return idxTab[idx];
+    }
+
+    /// dbConstLookup() specialized for UidMap
+    template <class TTab>
+    const typename TTab::value_type&
+    dbConstLookup(const UidMap &db, const TTab &idxTab, const int uid)
+    {
+        unsigned idx;
+        if (!db.find(&idx, uid)) {
+            CL_BREAK_IF("can't insert anything into const object");
+            return idxTab.front();
+        }
+
+        return idxTab[idx];
+    }
 }
 
 // /////////////////////////////////////////////////////////////////////////////
@@ -159,8 +253,7 @@ bool isOnStack(const Var &var)
 // /////////////////////////////////////////////////////////////////////////////
 // VarDb implementation
 struct VarDb::Private {
-    typedef std::map<int, unsigned> TMap;
-    TMap db;
+    UidMap db;
 };
 
 VarDb::VarDb():
@@ -187,12 +280,17 @@ const Var& VarDb::operator[](int uid) const
     return dbConstLookup(d->db, vars_, uid);
 }
 
+bool VarDb::has(int uid) const
+{
+    unsigned idx;
+    return d->db.find(&idx, uid);
+}
+
 
 // /////////////////////////////////////////////////////////////////////////////
 // TypeDb implementation
 struct TypeDb::Private {
-    typedef std::map<int, const struct cl_type *> TMap;
-    TMap db;
+    UidMap db;
 
     int codePtrSizeof;
     int dataPtrSizeof;
@@ -253,14 +351,12 @@ bool TypeDb::insert(const struct cl_type *clt)
     }
     const int uid = clt->uid;
 
-    typedef Private::TMap TDb;
-    TDb &db = d->db;
-    TDb::iterator iter = db.find(uid);
-    if (db.end() != iter)
+    unsigned idx;
+    if (d->db.find(&idx, uid))
         return false;
 
     // insert type into db
-    db[uid] = clt;
+    d->db.insert(uid, types_.size());
     types_.push_back(clt);
 
     d->digPtrSizeof(clt);
@@ -308,10 +404,8 @@ void readTypeTree(TypeDb &db, const struct cl_type *clt)
 
 const struct cl_type* TypeDb::operator[](int uid) const
 {
-    typedef Private::TMap TDb;
-    TDb &db = d->db;
-    TDb::iterator iter = db.find(uid);
-    if (db.end() == iter) {
+    unsigned idx;
+    if (!d->db.find(&idx, uid)) {
         CL_DEBUG("TypeDb::insert() is unable to find the required cl_type: #"
                 << uid);
 
@@ -320,7 +414,13 @@ const struct cl_type* TypeDb::operator[](int uid) const
         return 0;
     }
 
-    return iter->second;
+    return types_[idx];
+}
+
+bool TypeDb::has(int uid) const
+{
+    unsigned idx;
+    return d->db.find(&idx, uid);
 }
 
 
@@ -474,8 +574,7 @@ bool isDefined(const Fnc &fnc)
 // /////////////////////////////////////////////////////////////////////////////
 // FncDb implementation
 struct FncDb::Private {
-    typedef std::map<int, unsigned> TMap;
-    TMap db;
+    UidMap db;
 };
 
 FncDb::FncDb():
@@ -517,4 +616,10 @@ const Fnc* FncDb::operator[](int uid) const
     return dbConstLookup(d->db, fncs_, uid);
 }
 
+bool FncDb::has(int uid) const
+{
+    unsigned idx;
+    return d->db.find(&idx, uid);
+}
+
 } // namespace CodeStorage
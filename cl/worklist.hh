@@ -22,9 +22,12 @@
 
 #include "util.hh"
 
+#include <algorithm>
 #include <queue>
 #include <set>
 #include <stack>
+#include <utility>
+#include <vector>
 
 template <class T, class TShed> struct WorkListLib { };
 
@@ -42,15 +45,145 @@ struct WorkListLib<T, std::queue<T> > {
     }
 };
 
+/// hash function used by FlatSet, integral types and enums (IDs) hash to self
+template <class T>
+struct WorkListHash {
+    size_t operator()(const T &item) const {
+        return static_cast<size_t>(item);
+    }
+};
+
+template <class T1, class T2>
+struct WorkListHash<std::pair<T1, T2> > {
+    size_t operator()(const std::pair<T1, T2> &item) const {
+        const size_t h1 = WorkListHash<T1>()(item.first);
+        const size_t h2 = WorkListHash<T2>()(item.second);
+        return h1 ^ (h2 + 0x9e3779b9U + (h1 << 6) + (h1 >> 2));
+    }
+};
+
+/**
+ * set based on a flat open-addressing hash table (linear probing)
+ *
+ * Unlike std::set, it does not allocate per item.  clear() is O(1) and keeps
+ * the already allocated table, so an instance can be reused across calls.  It
+ * provides only the subset of the std::set API needed by WorkList (find()
+ * returns a pointer, 0 stands for end()).
+ */
+template <class T, class THash = WorkListHash<T> >
+class FlatSet {
+    public:
+        typedef T key_type;
+        typedef const T *const_iterator;
+
+        FlatSet():
+            gen_(1U),
+            size_(0U)
+        {
+        }
+
+        const_iterator end() const {
+            return 0;
+        }
+
+        const_iterator find(const T &key) const {
+            if (!size_)
+                return 0;
+
+            const size_t idx = this->lookup(key);
+            return (gen_ == stamps_[idx])
+                ? &keys_[idx]
+                : 0;
+        }
+
+        std::pair<const_iterator, bool> insert(const T &key) {
+            // keep the load factor below 1/2
+            if (keys_.size() <= 2U * (size_ + 1U))
+                this->grow();
+
+            const size_t idx = this->lookup(key);
+            if (gen_ == stamps_[idx])
+                return std::make_pair(&keys_[idx], false);
+
+            keys_[idx] = key;
+            stamps_[idx] = gen_;
+            ++size_;
+            return std::make_pair(&keys_[idx], true);
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return !size_;
+        }
+
+        void clear() {
+            size_ = 0U;
+            if (++gen_)
+                return;
+
+            // generation counter wrapped around, wipe the stamps explicitly
+            std::fill(stamps_.begin(), stamps_.end(), 0U);
+            gen_ = 1U;
+        }
+
+    private:
+        std::vector<T>          keys_;
+        std::vector<unsigned>   stamps_;    ///< slot is used iff stamp == gen_
+        unsigned                gen_;
+        size_t                  size_;
+
+        /// return the slot holding key, or the free slot where it belongs
+        size_t lookup(const T &key) const {
+            const size_t mask = keys_.size() - 1U;
+            size_t idx = THash()(key) * 0x9e3779b1U;
+            idx ^= idx >> 15;
+            for (idx &= mask; gen_ == stamps_[idx]; idx = (idx + 1U) & mask)
+                if (keys_[idx] == key)
+                    break;
+
+            return idx;
+        }
+
+        void grow() {
+            std::vector<T> keys;
+            std::vector<unsigned> stamps;
+            keys.swap(keys_);
+            stamps.swap(stamps_);
+
+            const size_t cap = (keys.empty())
+                ? 0x40U
+                : (keys.size() << 1);
+
+            keys_.resize(cap);
+            stamps_.resize(cap, 0U);
+
+            const unsigned gen = gen_;
+            gen_ = 1U;
+            size_ = 0U;
+            for (size_t i = 0U; i < keys.size(); ++i) {
+                if (gen != stamps[i])
+                    continue;
+
+                const size_t idx = this->lookup(keys[i]);
+                keys_[idx] = keys[i];
+                stamps_[idx] = gen_;
+                ++size_;
+            }
+        }
+};
+
 /// really stupid, but easy to use, DFS implementation
-template <class T, class TSched = std::stack<T> >
+template <class T, class TSched = std::stack<T>, class TSeen = std::set<T> >
 class WorkList {
     public:
         typedef T value_type;
 
     protected:
         TSched        todo_;
-        std::set<T>   seen_;
+        TSeen         seen_;
 
     public:
         WorkList() { }
@@ -69,11 +202,10 @@ class WorkList {
         }
 
         bool schedule(const T &item) {
-            if (hasKey(seen_, item))
+            if (!insertOnce(seen_, item))
                 return false;
 
             todo_.push(item);
-            seen_.insert(item);
             return true;
         }
 
@@ -81,6 +213,14 @@ class WorkList {
             return hasKey(seen_, item);
         }
 
+        /// forget everything, but keep the storage allocated by TSeen if any
+        void clear() {
+            while (!todo_.empty())
+                todo_.pop();
+
+            seen_.clear();
+        }
+
         unsigned cntSeen() const { return seen_.size(); }
         unsigned cntTodo() const { return todo_.size(); }
 };
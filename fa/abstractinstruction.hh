@@ -43,6 +43,7 @@ namespace CodeStorage {
 }
 
 class ExecutionManager;
+class FAE;
 
 enum class fi_type_e { fiAbort, fiBranch, fiCheck, fiFix, fiJump, fiUnspec };
 
@@ -126,6 +127,27 @@ public:
 	virtual void execute(ExecutionManager& execMan, const ExecState& state) = 0;
 
 
+	/**
+	 * @brief  Executes the instruction directly on given registers
+	 *
+	 * Deterministic instructions with a single successor that modify only the
+	 * registers override this method, so that they can be executed on the
+	 * register file of the state reaching them, without creating a new symbolic
+	 * state for each of them.
+	 *
+	 * @param[in,out]  regs  The registers of the state
+	 * @param[in]      fae   The forest automaton of the state (not modified)
+	 *
+	 * @returns  The next instruction, or @p nullptr if the instruction needs to
+	 *           be executed in a symbolic state of its own
+	 */
+	virtual AbstractInstruction* executeInPlace(DataArray& /* regs */,
+		const FAE& /* fae */) const
+	{
+		return nullptr;
+	}
+
+
 	/**
 	 * @brief  Outputs instruction to std::ostream
 	 *
@@ -170,6 +170,7 @@ class Box : public StructuralBox
 private:  // data types
 
 	friend class BoxMan;
+	friend class BoxDb;
 
 private:  // data members
 
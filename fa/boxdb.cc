@@ -0,0 +1,1084 @@
+/*
+ * Copyright (C) 2012 Ondrej Lengal
+ *
+ * This file is part of forester.
+ *
+ * forester is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * forester is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with forester.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard library headers
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+// Forester headers
+#include "boxdb.hh"
+#include "streams.hh"
+
+namespace
+{
+	/// magic string at the beginning of the database file
+	const char DB_MAGIC[8] = { 'F', 'A', 'B', 'O', 'X', 'D', 'B', '\0' };
+
+	/// version of the format, bump on any change of the layout
+	const uint64_t DB_VERSION = 1;
+
+	/// sentinel for a box that cannot be stored
+	const size_t NOT_STORED = static_cast<size_t>(-1);
+
+	enum class item_kind_e : uint8_t { iSel, iType, iBox };
+
+	/**
+	 * @brief  Writes the database in a fixed (little-endian) byte order
+	 */
+	class Writer
+	{
+		std::ostream& os_;
+
+	public:
+
+		explicit Writer(std::ostream& os) :
+			os_(os)
+		{ }
+
+		void putU8(uint8_t x)
+		{
+			os_.put(static_cast<char>(x));
+		}
+
+		void putU64(uint64_t x)
+		{
+			char buf[8];
+			for (size_t i = 0; i < sizeof(buf); ++i, x >>= 8)
+				buf[i] = static_cast<char>(x & 0xff);
+
+			os_.write(buf, sizeof(buf));
+		}
+
+		void putInt(int x)
+		{
+			this->putU64(static_cast<uint64_t>(static_cast<int64_t>(x)));
+		}
+
+		void putStr(const std::string& str)
+		{
+			this->putU64(str.size());
+			os_.write(str.data(), str.size());
+		}
+
+		template <class C>
+		void putSeq(const C& seq)
+		{
+			this->putU64(seq.size());
+			for (auto& x : seq)
+				this->putU64(x);
+		}
+	};
+
+	/**
+	 * @brief  Reads the database written by Writer
+	 */
+	class Reader
+	{
+		std::istream& is_;
+
+		/// position of the end of the stream
+		std::streamoff end_;
+
+		void check()
+		{
+			if (!is_)
+				throw std::runtime_error("truncated");
+		}
+
+	public:
+
+		explicit Reader(std::istream& is) :
+			is_(is),
+			end_(0)
+		{
+			const std::streampos pos = is_.tellg();
+			is_.seekg(0, std::ios::end);
+			end_ = is_.tellg();
+			is_.seekg(pos);
+			this->check();
+		}
+
+		/**
+		 * @brief  Reads the number of elements of a sequence
+		 *
+		 * The number is checked against the size of the rest of the stream
+		 * such that a corrupted length cannot make us allocate more memory
+		 * than the file could possibly describe.
+		 *
+		 * @param[in]  minSize  The minimal size of an element in bytes
+		 */
+		size_t getCount(size_t minSize = 1)
+		{
+			const uint64_t cnt = this->getU64();
+			const uint64_t rest = static_cast<uint64_t>(end_ - is_.tellg());
+			if (rest / minSize < cnt)
+				throw std::runtime_error("truncated");
+
+			return static_cast<size_t>(cnt);
+		}
+
+		uint8_t getU8()
+		{
+			char c = 0;
+			is_.get(c);
+			this->check();
+			return static_cast<uint8_t>(c);
+		}
+
+		uint64_t getU64()
+		{
+			unsigned char buf[8];
+			is_.read(reinterpret_cast<char*>(buf), sizeof(buf));
+			this->check();
+
+			uint64_t x = 0;
+			for (size_t i = sizeof(buf); i; --i)
+				x = (x << 8) | buf[i - 1];
+
+			return x;
+		}
+
+		int getInt()
+		{
+			return static_cast<int>(static_cast<int64_t>(this->getU64()));
+		}
+
+		std::string getStr()
+		{
+			std::string str(this->getCount(), '\0');
+			is_.read(&str[0], str.size());
+			this->check();
+			return str;
+		}
+
+		void getSeq(std::vector<size_t>& seq)
+		{
+			seq.resize(this->getCount(sizeof(uint64_t)));
+			for (auto& x : seq)
+				x = this->getU64();
+		}
+
+		void getSeq(std::set<size_t>& seq)
+		{
+			for (size_t cnt = this->getCount(sizeof(uint64_t)); cnt; --cnt)
+				seq.insert(this->getU64());
+		}
+	};
+} // namespace
+
+
+/**
+ * @brief  An item of a node label (a selector, a type, or a nested box)
+ */
+struct BoxDb::Item
+{
+	item_kind_e kind;
+	size_t      offset;     ///< offset of a selector or index of a type/box
+	int         size;
+	int         displ;
+	std::string name;
+
+	Item(item_kind_e kind, size_t offset) :
+		kind(kind),
+		offset(offset),
+		size(0),
+		displ(0),
+		name()
+	{ }
+
+	explicit Item(const SelData& sel) :
+		kind(item_kind_e::iSel),
+		offset(sel.offset),
+		size(sel.size),
+		displ(sel.displ),
+		name(sel.name)
+	{ }
+
+	SelData toSelData() const
+	{
+		return SelData(offset, size, displ, name);
+	}
+};
+
+/**
+ * @brief  A label of a transition (either a node or a data label)
+ */
+struct BoxDb::Label
+{
+	bool              isNode;
+	std::vector<Item> items;
+	bool              hasSels;
+	std::vector<Item> sels;
+	Data              data;
+
+	Label() :
+		isNode(false),
+		items(),
+		hasSels(false),
+		sels(),
+		data()
+	{ }
+};
+
+/**
+ * @brief  A tree automaton with labels referring to Record::labels
+ */
+struct BoxDb::Automaton
+{
+	struct Transition
+	{
+		std::vector<size_t> lhs;
+		size_t              label;
+		size_t              rhs;
+
+		Transition() :
+			lhs(),
+			label(0),
+			rhs(0)
+		{ }
+	};
+
+	std::vector<size_t>     finalStates;
+	std::vector<Transition> transitions;
+
+	Automaton() :
+		finalStates(),
+		transitions()
+	{ }
+};
+
+/**
+ * @brief  A box as stored in the database
+ */
+struct BoxDb::Record
+{
+	typedef std::pair<std::string, std::vector<size_t>> TType;
+
+	std::vector<TType>                      types;
+	std::vector<Label>                      labels;
+	Automaton                               output;
+	bool                                    hasInput;
+	Automaton                               input;
+	ConnectionGraph::CutpointSignature      outputSignature;
+	ConnectionGraph::CutpointSignature      inputSignature;
+	std::vector<size_t>                     inputMap;
+	size_t                                  inputIndex;
+	std::vector<std::pair<size_t, size_t>>  selectors;
+
+	Record() :
+		types(),
+		labels(),
+		output(),
+		hasInput(false),
+		input(),
+		outputSignature(),
+		inputSignature(),
+		inputMap(),
+		inputIndex(0),
+		selectors()
+	{ }
+};
+
+
+namespace
+{
+	typedef std::unordered_map<const Box*, size_t> TBoxIndex;
+
+	bool isStorable(const Data& data)
+	{
+		switch (data.type)
+		{
+			case data_type_e::t_native_ptr:
+				return false;
+
+			case data_type_e::t_struct:
+				for (auto& item : *data.d_struct)
+				{
+					if (!isStorable(item.second))
+						return false;
+				}
+				return true;
+
+			default:
+				return true;
+		}
+	}
+
+	/**
+	 * @brief  Converts a box of the box manager into a database record
+	 */
+	class RecordBuilder
+	{
+		BoxDb::Record& rec_;
+		const TBoxIndex& boxIndex_;
+		std::unordered_map<const NodeLabel*, size_t> labelIndex_;
+		std::unordered_map<const TypeBox*, size_t> typeIndex_;
+
+		bool addLabel(size_t& index, const NodeLabel& label)
+		{
+			auto p = labelIndex_.insert(std::make_pair(&label, rec_.labels.size()));
+			index = p.first->second;
+			if (!p.second)
+				return true;
+
+			BoxDb::Label dst;
+			if (label.isData())
+			{
+				if (!isStorable(label.getData()))
+					return false;
+
+				dst.data = label.getData();
+				rec_.labels.push_back(dst);
+				return true;
+			}
+
+			if (!label.isNode())
+				return false;
+
+			dst.isNode = true;
+			for (const AbstractBox* aBox : label.getNode())
+			{
+				switch (aBox->getType())
+				{
+					case box_type_e::bSel:
+						dst.items.push_back(BoxDb::Item(
+							static_cast<const SelBox*>(aBox)->getData()));
+						break;
+
+					case box_type_e::bTypeInfo:
+					{
+						const TypeBox* tBox = static_cast<const TypeBox*>(aBox);
+						auto q = typeIndex_.insert(
+							std::make_pair(tBox, rec_.types.size()));
+						if (q.second)
+						{
+							rec_.types.push_back(
+								std::make_pair(tBox->getName(), tBox->getSelectors()));
+						}
+
+						dst.items.push_back(
+							BoxDb::Item(item_kind_e::iType, q.first->second));
+						break;
+					}
+
+					case box_type_e::bBox:
+					{
+						auto iter = boxIndex_.find(static_cast<const Box*>(aBox));
+						if ((boxIndex_.end() == iter) || (NOT_STORED == iter->second))
+							return false;
+
+						dst.items.push_back(BoxDb::Item(item_kind_e::iBox, iter->second));
+						break;
+					}
+				}
+			}
+
+			if (nullptr != label.node.sels)
+			{
+				dst.hasSels = true;
+				for (const SelData& sel : *label.node.sels)
+					dst.sels.push_back(BoxDb::Item(sel));
+			}
+
+			rec_.labels.push_back(dst);
+			return true;
+		}
+
+	public:
+
+		RecordBuilder(BoxDb::Record& rec, const TBoxIndex& boxIndex) :
+			rec_(rec),
+			boxIndex_(boxIndex),
+			labelIndex_{},
+			typeIndex_{}
+		{ }
+
+		bool addAutomaton(BoxDb::Automaton& dst, const TreeAut& ta)
+		{
+			dst.finalStates.assign(ta.getFinalStates().begin(),
+				ta.getFinalStates().end());
+
+			for (auto it = ta.begin(); it != ta.end(); ++it)
+			{
+				BoxDb::Automaton::Transition t;
+				t.lhs = it->lhs();
+				t.rhs = it->rhs();
+				if (!this->addLabel(t.label, *it->label()))
+					return false;
+
+				dst.transitions.push_back(t);
+			}
+
+			return true;
+		}
+	};
+
+	void collectNestedBoxes(std::vector<const Box*>& dst, const TreeAut* ta)
+	{
+		if (nullptr == ta)
+			return;
+
+		for (auto it = ta->begin(); it != ta->end(); ++it)
+		{
+			if (!it->label()->isNode())
+				continue;
+
+			for (const AbstractBox* aBox : it->label()->getNode())
+			{
+				if (box_type_e::bBox == aBox->getType())
+					dst.push_back(static_cast<const Box*>(aBox));
+			}
+		}
+	}
+
+	void writeSignature(Writer& w, const ConnectionGraph::CutpointSignature& sig)
+	{
+		w.putU64(sig.size());
+		for (auto& cutpoint : sig)
+		{
+			w.putU64(cutpoint.root);
+			w.putU64(cutpoint.refCount);
+			w.putU64(cutpoint.selCount);
+			w.putU8(cutpoint.refInherited);
+			w.putSeq(cutpoint.fwdSelectors);
+			w.putU64(cutpoint.bwdSelector);
+			w.putSeq(cutpoint.defines);
+		}
+	}
+
+	void readSignature(Reader& r, ConnectionGraph::CutpointSignature& sig)
+	{
+		sig.resize(r.getCount(sizeof(uint64_t)));
+		for (auto& cutpoint : sig)
+		{
+			cutpoint.root = r.getU64();
+			cutpoint.refCount = r.getU64();
+			cutpoint.selCount = r.getU64();
+			cutpoint.refInherited = r.getU8();
+			cutpoint.fwdSelectors.clear();
+			r.getSeq(cutpoint.fwdSelectors);
+			cutpoint.bwdSelector = r.getU64();
+			r.getSeq(cutpoint.defines);
+		}
+	}
+
+	void writeItem(Writer& w, const BoxDb::Item& item, const std::vector<size_t>* remap)
+	{
+		w.putU8(static_cast<uint8_t>(item.kind));
+		switch (item.kind)
+		{
+			case item_kind_e::iSel:
+				w.putU64(item.offset);
+				w.putInt(item.size);
+				w.putInt(item.displ);
+				w.putStr(item.name);
+				break;
+
+			case item_kind_e::iType:
+				w.putU64(item.offset);
+				break;
+
+			case item_kind_e::iBox:
+				// Assertions
+				assert(!remap || item.offset < remap->size());
+
+				w.putU64((remap)?((*remap)[item.offset]):(item.offset));
+				break;
+		}
+	}
+
+	BoxDb::Item readItem(Reader& r)
+	{
+		const uint8_t kind = r.getU8();
+		switch (kind)
+		{
+			case static_cast<uint8_t>(item_kind_e::iSel):
+			{
+				BoxDb::Item item(item_kind_e::iSel, r.getU64());
+				item.size = r.getInt();
+				item.displ = r.getInt();
+				item.name = r.getStr();
+				return item;
+			}
+
+			case static_cast<uint8_t>(item_kind_e::iType):
+			case static_cast<uint8_t>(item_kind_e::iBox):
+				return BoxDb::Item(static_cast<item_kind_e>(kind), r.getU64());
+
+			default:
+				throw std::runtime_error("invalid item");
+		}
+	}
+
+	void writeData(Writer& w, const Data& data)
+	{
+		w.putU8(static_cast<uint8_t>(data.type));
+		w.putInt(data.size);
+		switch (data.type)
+		{
+			case data_type_e::t_void_ptr:
+				w.putU64(data.d_void_ptr_size);
+				break;
+
+			case data_type_e::t_ref:
+				w.putU64(data.d_ref.root);
+				w.putInt(data.d_ref.displ);
+				break;
+
+			case data_type_e::t_int:
+				w.putInt(data.d_int);
+				break;
+
+			case data_type_e::t_bool:
+				w.putU8(data.d_bool);
+				break;
+
+			case data_type_e::t_struct:
+				w.putU64(data.d_struct->size());
+				for (auto& item : *data.d_struct)
+				{
+					w.putU64(item.first);
+					writeData(w, item.second);
+				}
+				break;
+
+			case data_type_e::t_native_ptr:
+				// Assertions
+				assert(false);      // filtered by isStorable()
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	Data readData(Reader& r)
+	{
+		const uint8_t type = r.getU8();
+		if (type > static_cast<uint8_t>(data_type_e::t_other)
+			|| type == static_cast<uint8_t>(data_type_e::t_native_ptr))
+			throw std::runtime_error("invalid data");
+
+		Data data(static_cast<data_type_e>(type));
+		data.size = r.getInt();
+		switch (data.type)
+		{
+			case data_type_e::t_void_ptr:
+				data.d_void_ptr_size = r.getU64();
+				break;
+
+			case data_type_e::t_ref:
+				data.d_ref.root = r.getU64();
+				data.d_ref.displ = r.getInt();
+				break;
+
+			case data_type_e::t_int:
+				data.d_int = r.getInt();
+				break;
+
+			case data_type_e::t_bool:
+				data.d_bool = r.getU8();
+				break;
+
+			case data_type_e::t_struct:
+			{
+				std::vector<Data::item_info> items;
+				for (size_t cnt = r.getCount(sizeof(uint64_t)); cnt; --cnt)
+				{
+					const size_t offset = r.getU64();
+					items.push_back(std::make_pair(offset, readData(r)));
+				}
+
+				const int size = data.size;
+				data = Data::createStruct(items);
+				data.size = size;
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		return data;
+	}
+
+	void writeAutomaton(Writer& w, const BoxDb::Automaton& ta)
+	{
+		w.putSeq(ta.finalStates);
+		w.putU64(ta.transitions.size());
+		for (auto& t : ta.transitions)
+		{
+			w.putSeq(t.lhs);
+			w.putU64(t.label);
+			w.putU64(t.rhs);
+		}
+	}
+
+	void readAutomaton(Reader& r, BoxDb::Automaton& ta)
+	{
+		r.getSeq(ta.finalStates);
+		ta.transitions.resize(r.getCount(sizeof(uint64_t)));
+		for (auto& t : ta.transitions)
+		{
+			r.getSeq(t.lhs);
+			t.label = r.getU64();
+			t.rhs = r.getU64();
+		}
+	}
+
+	void writeRecord(
+		Writer& w,
+		const BoxDb::Record& rec,
+		const std::vector<size_t>* remap)
+	{
+		w.putU64(rec.types.size());
+		for (auto& type : rec.types)
+		{
+			w.putStr(type.first);
+			w.putSeq(type.second);
+		}
+
+		w.putU64(rec.labels.size());
+		for (auto& label : rec.labels)
+		{
+			w.putU8(label.isNode);
+			if (!label.isNode)
+			{
+				writeData(w, label.data);
+				continue;
+			}
+
+			w.putU64(label.items.size());
+			for (auto& item : label.items)
+				writeItem(w, item, remap);
+
+			w.putU8(label.hasSels);
+			w.putU64(label.sels.size());
+			for (auto& sel : label.sels)
+				writeItem(w, sel, remap);
+		}
+
+		writeAutomaton(w, rec.output);
+		w.putU8(rec.hasInput);
+		if (rec.hasInput)
+			writeAutomaton(w, rec.input);
+
+		writeSignature(w, rec.outputSignature);
+		writeSignature(w, rec.inputSignature);
+		w.putSeq(rec.inputMap);
+		w.putU64(rec.inputIndex);
+		w.putU64(rec.selectors.size());
+		for (auto& sel : rec.selectors)
+		{
+			w.putU64(sel.first);
+			w.putU64(sel.second);
+		}
+	}
+
+	void readRecord(Reader& r, BoxDb::Record& rec)
+	{
+		rec.types.resize(r.getCount(sizeof(uint64_t)));
+		for (auto& type : rec.types)
+		{
+			type.first = r.getStr();
+			r.getSeq(type.second);
+		}
+
+		rec.labels.resize(r.getCount());
+		for (auto& label : rec.labels)
+		{
+			label.isNode = r.getU8();
+			if (!label.isNode)
+			{
+				label.data = readData(r);
+				continue;
+			}
+
+			for (size_t cnt = r.getCount(); cnt; --cnt)
+				label.items.push_back(readItem(r));
+
+			label.hasSels = r.getU8();
+			for (size_t cnt = r.getCount(); cnt; --cnt)
+				label.sels.push_back(readItem(r));
+		}
+
+		readAutomaton(r, rec.output);
+		rec.hasInput = r.getU8();
+		if (rec.hasInput)
+			readAutomaton(r, rec.input);
+
+		readSignature(r, rec.outputSignature);
+		readSignature(r, rec.inputSignature);
+		r.getSeq(rec.inputMap);
+		rec.inputIndex = r.getU64();
+		rec.selectors.resize(r.getCount(sizeof(uint64_t)));
+		for (auto& sel : rec.selectors)
+		{
+			sel.first = r.getU64();
+			sel.second = r.getU64();
+		}
+	}
+
+	void checkAutomaton(const BoxDb::Automaton& ta, const BoxDb::Record& rec)
+	{
+		for (auto& t : ta.transitions)
+		{
+			if (t.label >= rec.labels.size())
+				throw std::runtime_error("invalid label");
+		}
+	}
+
+	/**
+	 * @brief  Checks the references of the record at the position @p index
+	 */
+	void checkRecord(const BoxDb::Record& rec, size_t index)
+	{
+		for (auto& label : rec.labels)
+		{
+			for (auto& item : label.items)
+			{
+				if (item_kind_e::iType == item.kind && item.offset >= rec.types.size())
+					throw std::runtime_error("invalid type");
+
+				if (item_kind_e::iBox == item.kind && item.offset >= index)
+					throw std::runtime_error("invalid box");
+			}
+		}
+
+		checkAutomaton(rec.output, rec);
+		if (rec.hasInput)
+			checkAutomaton(rec.input, rec);
+	}
+} // namespace
+
+
+BoxDb::~BoxDb()
+{
+	this->clear();
+}
+
+
+void BoxDb::clear()
+{
+	for (Record* rec : records_)
+		delete rec;
+
+	records_.clear();
+	loaded_.clear();
+}
+
+
+const Box* BoxDb::materialize(const Record& rec)
+{
+	std::vector<const TypeBox*> types;
+	for (auto& type : rec.types)
+	{
+		const TypeBox* tBox = boxMan_.lookupTypeInfo(type.first);
+		if ((nullptr == tBox) || (tBox->getSelectors() != type.second))
+		{
+			FA_DEBUG_AT(2, "box database: type " << type.first
+				<< " not compatible with the analysed program");
+			return nullptr;
+		}
+
+		types.push_back(tBox);
+	}
+
+	std::vector<label_type> labels;
+	for (auto& label : rec.labels)
+	{
+		if (!label.isNode)
+		{
+			labels.push_back(boxMan_.lookupLabel(label.data));
+			continue;
+		}
+
+		std::vector<const AbstractBox*> node;
+		const TypeBox* tBox = nullptr;
+		for (auto& item : label.items)
+		{
+			switch (item.kind)
+			{
+				case item_kind_e::iSel:
+					node.push_back(boxMan_.getSelector(item.toSelData()));
+					break;
+
+				case item_kind_e::iType:
+					// Assertions
+					assert(item.offset < types.size());
+
+					tBox = types[item.offset];
+					node.push_back(tBox);
+					break;
+
+				case item_kind_e::iBox:
+					// Assertions
+					assert(item.offset < loaded_.size());
+
+					if (nullptr == loaded_[item.offset])
+						return nullptr;
+
+					node.push_back(loaded_[item.offset]);
+					break;
+			}
+		}
+
+		const std::vector<SelData>* sels = nullptr;
+		if (label.hasSels && tBox)
+		{
+			std::vector<SelData> tmp;
+			for (auto& sel : label.sels)
+				tmp.push_back(sel.toSelData());
+
+			sels = boxMan_.LookupTypeDesc(tBox, tmp);
+		}
+
+		labels.push_back(boxMan_.lookupLabel(node, sels));
+	}
+
+	auto build = [this, &labels](const Automaton& src) -> std::shared_ptr<TreeAut>
+	{
+		std::shared_ptr<TreeAut> ta(new TreeAut(backend_));
+		for (auto& t : src.transitions)
+		{
+			// Assertions
+			assert(t.label < labels.size());
+
+			ta->addTransition(t.lhs, labels[t.label], t.rhs);
+		}
+
+		for (size_t state : src.finalStates)
+			ta->addFinalState(state);
+
+		return ta;
+	};
+
+	Box box(
+		"",
+		build(rec.output),
+		rec.outputSignature,
+		rec.inputMap,
+		(rec.hasInput)?(build(rec.input)):(std::shared_ptr<TreeAut>(nullptr)),
+		rec.inputIndex,
+		rec.inputSignature,
+		rec.selectors
+	);
+
+	return boxMan_.loadBox(box);
+}
+
+
+size_t BoxDb::load(const std::string& fileName)
+{
+	this->clear();
+
+	std::ifstream input(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!input.good())
+	{
+		FA_DEBUG_AT(1, "box database " << fileName << " not found, starting empty");
+		return 0;
+	}
+
+	char magic[sizeof(DB_MAGIC)];
+	input.read(magic, sizeof(magic));
+	if (!input || std::memcmp(magic, DB_MAGIC, sizeof(magic)))
+	{
+		FA_WARN(fileName << " is not a box database, ignoring it");
+		return 0;
+	}
+
+	try
+	{
+		Reader r(input);
+		const uint64_t version = r.getU64();
+		if (DB_VERSION != version)
+		{
+			FA_WARN("box database " << fileName << " has unsupported version "
+				<< version << ", ignoring it");
+			return 0;
+		}
+
+		// read (and check) all records before loading any box, such that a
+		// corrupted database leaves the box manager untouched
+		for (size_t cnt = r.getCount(); cnt; --cnt)
+		{
+			Record* rec = new Record;
+			records_.push_back(rec);
+			readRecord(r, *rec);
+			checkRecord(*rec, records_.size() - 1);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		FA_WARN("box database " << fileName << " is corrupted (" << e.what()
+			<< "), ignoring it");
+		this->clear();
+		return 0;
+	}
+
+	size_t cntLoaded = 0;
+	for (const Record* rec : records_)
+	{
+		const Box* box = this->materialize(*rec);
+		loaded_.push_back(box);
+		if (box)
+			++cntLoaded;
+	}
+
+	FA_LOG("loaded " << cntLoaded << " of " << records_.size()
+		<< " box(es) from " << fileName);
+
+	return cntLoaded;
+}
+
+
+size_t BoxDb::save(const std::string& fileName) const
+{
+	std::vector<const Box*> boxes;
+	boxMan_.boxDatabase().asVector(boxes);
+
+	// boxes loaded from the database may be obsolete (covered by a bigger box)
+	// but they still need to be stored for the records that depend on them
+	for (const Box* box : loaded_)
+	{
+		if (box)
+			boxes.push_back(box);
+	}
+
+	// order the boxes such that nested boxes go first
+	TBoxIndex boxIndex;
+	std::vector<Record*> out;
+	std::vector<std::pair<const Box*, bool>> stack;
+	for (const Box* root : boxes)
+	{
+		stack.push_back(std::make_pair(root, false));
+		while (!stack.empty())
+		{
+			const Box* box = stack.back().first;
+			const bool expanded = stack.back().second;
+			stack.pop_back();
+
+			if (expanded)
+			{
+				std::unique_ptr<Record> rec(new Record);
+				RecordBuilder builder(*rec, boxIndex);
+				bool ok = builder.addAutomaton(rec->output, *box->getOutput());
+				if (ok && box->getInput())
+				{
+					rec->hasInput = true;
+					ok = builder.addAutomaton(rec->input, *box->getInput());
+				}
+
+				rec->outputSignature = box->outputSignature_;
+				rec->inputSignature = box->inputSignature_;
+				rec->inputMap = box->inputMap_;
+				rec->inputIndex = box->inputIndex_;
+				rec->selectors = box->selectors_;
+
+				if (!ok)
+				{
+					FA_DEBUG_AT(2, "box database: not storing "
+						<< *static_cast<const AbstractBox*>(box));
+					boxIndex[box] = NOT_STORED;
+					continue;
+				}
+
+				boxIndex[box] = out.size();
+				out.push_back(rec.release());
+				continue;
+			}
+
+			if (!boxIndex.insert(std::make_pair(box, NOT_STORED)).second)
+				continue;
+
+			stack.push_back(std::make_pair(box, true));
+
+			std::vector<const Box*> nested;
+			collectNestedBoxes(nested, box->getOutput());
+			collectNestedBoxes(nested, box->getInput());
+			for (const Box* nestedBox : nested)
+			{
+				if (!boxIndex.count(nestedBox))
+					stack.push_back(std::make_pair(nestedBox, false));
+			}
+		}
+	}
+
+	const size_t cntLive = out.size();
+
+	// keep the records which were not usable in this run, remapping their
+	// references to nested boxes to the new positions
+	std::vector<size_t> remap(records_.size(), NOT_STORED);
+	std::vector<const Record*> kept;
+	for (size_t i = 0; i < records_.size(); ++i)
+	{
+		if (loaded_[i])
+		{
+			remap[i] = boxIndex[loaded_[i]];
+			continue;
+		}
+
+		bool ok = true;
+		for (auto& label : records_[i]->labels)
+		{
+			for (auto& item : label.items)
+			{
+				if (item_kind_e::iBox == item.kind
+					&& (item.offset >= i || NOT_STORED == remap[item.offset]))
+					ok = false;
+			}
+		}
+
+		if (!ok)
+			continue;
+
+		remap[i] = cntLive + kept.size();
+		kept.push_back(records_[i]);
+	}
+
+	std::ofstream output(fileName.c_str(),
+		std::ios::out | std::ios::binary | std::ios::trunc);
+
+	output.write(DB_MAGIC, sizeof(DB_MAGIC));
+
+	Writer w(output);
+	w.putU64(DB_VERSION);
+	w.putU64(cntLive + kept.size());
+	for (const Record* rec : out)
+		writeRecord(w, *rec, nullptr);
+
+	for (const Record* rec : kept)
+		writeRecord(w, *rec, &remap);
+
+	for (Record* rec : out)
+		delete rec;
+
+	output.close();
+	if (!output)
+		throw std::runtime_error("unable to write box database " + fileName);
+
+	FA_LOG("saved " << cntLive << " learned and " << kept.size()
+		<< " inherited box(es) to " << fileName);
+
+	return cntLive + kept.size();
+}
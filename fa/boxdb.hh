@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2012 Ondrej Lengal
+ *
+ * This file is part of forester.
+ *
+ * forester is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * forester is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with forester.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BOXDB_HH_
+#define _BOXDB_HH_
+
+/**
+ * @file boxdb.hh
+ * BoxDb - persistent database of learned boxes
+ */
+
+// Standard library headers
+#include <string>
+#include <vector>
+
+// Forester headers
+#include "boxman.hh"
+#include "treeaut_label.hh"
+
+/**
+ * @brief  Persistent database of learned boxes
+ *
+ * The database stores the hierarchy of boxes learned by the box manager in
+ * a versioned binary file, so that a subsequent run of Forester on the same
+ * (or a related) program can start with the boxes already known and avoid the
+ * restarts of the analysis caused by their discovery.
+ *
+ * Boxes are stored in the order such that a box only refers to boxes stored
+ * before it.  Selectors and data are stored by value, types are stored by
+ * name together with their selectors.  A box is only loaded if all types it
+ * refers to exist in the analysed program with the same layout; the records
+ * that cannot be loaded are kept and written back on save, i.e. the database
+ * is merged rather than overwritten.
+ */
+class BoxDb
+{
+public:   // data types
+
+	struct Item;
+	struct Label;
+	struct Automaton;
+	struct Record;
+
+private:  // data members
+
+	/// the backend used for the loaded tree automata
+	TreeAut::Backend& backend_;
+
+	/// the box manager the boxes are loaded into
+	BoxMan& boxMan_;
+
+	/// records read from the database (in the order of the file)
+	std::vector<Record*> records_;
+
+	/// boxes created from @p records_ (@p nullptr if not loaded)
+	std::vector<const Box*> loaded_;
+
+private:  // methods
+
+	BoxDb(const BoxDb&);
+	BoxDb& operator=(const BoxDb&);
+
+	const Box* materialize(const Record& rec);
+
+	void clear();
+
+public:   // methods
+
+	/**
+	 * @brief  Constructor
+	 *
+	 * @param[in]  backend  The backend for the loaded tree automata
+	 * @param[in]  boxMan   The box manager the boxes are loaded into
+	 */
+	BoxDb(TreeAut::Backend& backend, BoxMan& boxMan) :
+		backend_(backend),
+		boxMan_(boxMan),
+		records_{},
+		loaded_{}
+	{ }
+
+	~BoxDb();
+
+	/**
+	 * @brief  Loads boxes from a database file
+	 *
+	 * Reads the database from the file @p fileName and registers all boxes
+	 * compatible with the types of the analysed program in the box manager.
+	 * Types need to be loaded into the box manager first.  A missing file is
+	 * not an error (there is nothing to load yet).  A corrupted (or truncated)
+	 * file is ignored with a warning and the analysis starts with no boxes.
+	 *
+	 * @param[in]  fileName  Name of the database file
+	 *
+	 * @returns  The number of loaded boxes
+	 */
+	size_t load(const std::string& fileName);
+
+	/**
+	 * @brief  Saves boxes to a database file
+	 *
+	 * Writes all boxes known to the box manager, followed by the records
+	 * loaded previously that could not be used in this run, to the file @p
+	 * fileName.
+	 *
+	 * @param[in]  fileName  Name of the database file
+	 *
+	 * @returns  The number of saved boxes
+	 *
+	 * @throws  std::runtime_error  if the file cannot be written
+	 */
+	size_t save(const std::string& fileName) const;
+};
+
+#endif /* _BOXDB_HH_ */
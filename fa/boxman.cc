@@ -91,12 +91,15 @@ void BoxAntichain::asVector(std::vector<const Box*>& boxes) const
 
 const std::pair<const Data, NodeLabel*>& BoxMan::insertData(const Data& data)
 {
+	++cntLookups_;
+
 	std::pair<TDataStore::iterator, bool> p = dataStore_.insert(
 		std::make_pair(data, static_cast<NodeLabel*>(nullptr)));
 
 	if (p.second)
 	{
-		p.first->second = new NodeLabel(&p.first->first, dataIndex_.size());
+		p.first->second = registerLabel(
+			new NodeLabel(&p.first->first, dataIndex_.size()));
 		dataIndex_.push_back(&p.first->first);
 	}
 	return *p.first;
@@ -118,10 +121,12 @@ std::string BoxMan::getBoxName() const
 
 label_type BoxMan::lookupLabel(size_t arity, const DataArray& x)
 {
+	++cntLookups_;
+
 	std::pair<TVarDataStore::iterator, bool> p = vDataStore_.insert(
 		std::make_pair(std::make_pair(arity, x), static_cast<NodeLabel*>(nullptr)));
 	if (p.second)
-		p.first->second = new NodeLabel(&p.first->first.second);
+		p.first->second = registerLabel(new NodeLabel(&p.first->first.second));
 
 	return p.first->second;
 }
@@ -169,12 +174,14 @@ label_type BoxMan::lookupLabel(
 	const std::vector<const AbstractBox*>& x,
 	const std::vector<SelData>* nodeInfo)
 {
+	++cntLookups_;
+
 	std::pair<TNodeStore::iterator, bool> p = nodeStore_.insert(
 		std::make_pair(x, static_cast<NodeLabel*>(nullptr)));
 
 	if (p.second)
 	{
-		NodeLabel* label = new NodeLabel(&p.first->first, nodeInfo);
+		NodeLabel* label = registerLabel(new NodeLabel(&p.first->first, nodeInfo));
 
 		std::vector<size_t> tag;
 
@@ -361,7 +368,14 @@ Box* BoxMan::createType2Box(
 }
 
 
-const Box* BoxMan::getBox(const Box& box)
+const TypeBox* BoxMan::lookupTypeInfo(const std::string& name) const
+{
+	TTypeIndex::const_iterator i = typeIndex_.find(name);
+	return (i == typeIndex_.end())?(nullptr):(i->second);
+}
+
+
+const Box* BoxMan::insertBox(const Box& box, const char* verb)
 {
 	auto cpBox = boxes_.get(box);
 
@@ -372,18 +386,33 @@ const Box* BoxMan::getBox(const Box& box)
 		pBox->name_ = this->getBoxName();
 		pBox->initialize();
 
-		FA_DEBUG_AT(1, "learning " << *static_cast<const AbstractBox*>(cpBox)
+		FA_DEBUG_AT(1, verb << ' ' << *static_cast<const AbstractBox*>(cpBox)
 			<< ':' << std::endl << *cpBox);
+	}
+
+	return cpBox;
+}
+
+
+const Box* BoxMan::getBox(const Box& box)
+{
+	auto cpBox = this->insertBox(box, "learning");
 
 #if FA_RESTART_AFTER_BOX_DISCOVERY
+	if (boxes_.modified())
 		throw RestartRequest("a new box encountered");
 #endif
-	}
 
 	return cpBox;
 }
 
 
+const Box* BoxMan::loadBox(const Box& box)
+{
+	return this->insertBox(box, "loading");
+}
+
+
 void BoxMan::clear()
 {
 	utils::eraseMap(dataStore_);
@@ -394,4 +423,6 @@ void BoxMan::clear()
 	utils::eraseMap(selIndex_);
 	utils::eraseMap(typeIndex_);
 	boxes_.clear();
+	cntLabels_ = 0;
+	cntLookups_ = 0;
 }
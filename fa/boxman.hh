@@ -161,12 +161,26 @@ private:  // data members
 
 	TTypeDescDict typeDescDict_;
 
+	/// the number of labels created so far (the next NodeLabel::uid)
+	size_t cntLabels_;
+
+	/// the number of label look-ups
+	size_t cntLookups_;
+
 private:  // methods
 
+	NodeLabel* registerLabel(NodeLabel* label)
+	{
+		label->uid = cntLabels_++;
+		return label;
+	}
+
 	const std::pair<const Data, NodeLabel*>& insertData(const Data& data);
 
 	std::string getBoxName() const;
 
+	const Box* insertBox(const Box& box, const char* verb);
+
 public:
 
 	label_type lookupLabel(const Data& data)
@@ -174,6 +188,12 @@ public:
 		return this->insertData(data).second;
 	}
 
+	/// the number of distinct labels
+	size_t labelCount() const { return cntLabels_; }
+
+	/// the number of label look-ups (of all kinds) done so far
+	size_t lookupCount() const { return cntLookups_; }
+
 	label_type lookupLabel(size_t arity, const DataArray& x);
 
 	const std::vector<SelData>* LookupTypeDesc(
@@ -235,6 +255,15 @@ public:
 
 	const TypeBox* getTypeInfo(const std::string& name);
 
+	/**
+	 * @brief  Looks up type information by name
+	 *
+	 * @param[in]  name  Name of the type
+	 *
+	 * @returns  The type information, @p nullptr if there is no such type
+	 */
+	const TypeBox* lookupTypeInfo(const std::string& name) const;
+
 	const TypeBox* createTypeInfo(const std::string& name,
 		const std::vector<size_t>& selectors);
 
@@ -266,6 +295,17 @@ public:
 
 	const Box* getBox(const Box& box);
 
+	/**
+	 * @brief  Inserts a box loaded from a box database
+	 *
+	 * Unlike @p getBox, a new box does not request a restart of the analysis.
+	 *
+	 * @param[in]  box  The box to be inserted
+	 *
+	 * @returns  The box stored in the box manager
+	 */
+	const Box* loadBox(const Box& box);
+
 	const Box* lookupBox(const Box& box) const
 	{
 		return boxes_.lookup(box);
@@ -280,7 +320,9 @@ public:
 		selIndex_{},
 		typeIndex_{},
 		boxes_{},
-		typeDescDict_{}
+		typeDescDict_{},
+		cntLabels_{},
+		cntLookups_{}
 	{ }
 
 	~BoxMan()
@@ -47,30 +47,8 @@ void userRequestHandler(int) {
 // required by the gcc plug-in API
 extern "C" { int plugin_is_GPL_compatible; }
 
-#if 0
-struct BoxDb {
-
-	std::unordered_map<std::string, std::string> store;
-
-	BoxDb(const std::string& root, const std::string& fileName) {
-		std::ifstream input((root + "/" + fileName).c_str());
-		if (!input.good())
-			throw std::runtime_error("Unable to open " + root + "/" + fileName);
-		std::string buf;
-		while (std::getline(input, buf)) {
-			if (buf.empty())
-				continue;
-			if (buf[0] == '#')
-				continue;
-			std::vector<std::string> data;
-			boost::split(data, buf, boost::is_from_range(':', ':'));
-			if (data.size() == 2)
-				this->store[data[0]] = root + "/" + data[1];
-		}
-	}
-
-};
-#endif
+/// name of the box database file inside of the db-root directory
+#define BOX_DB_FILE_NAME "boxes.db"
 
 void clEasyRun(const CodeStorage::Storage& stor, const char* configString)
 {
@@ -123,12 +101,15 @@ void clEasyRun(const CodeStorage::Storage& stor, const char* configString)
 		FA_LOG("loading types ...");
 		se->loadTypes(stor);
 
-/*
-		if (!conf.dbRoot.empty()){
-			BoxDb db(conf.dbRoot, "index");
-			se.loadBoxes(db.store);
+		const std::string boxDbFile = (conf.dbRoot.empty())
+			? std::string()
+			: conf.dbRoot + "/" BOX_DB_FILE_NAME;
+
+		if (!boxDbFile.empty())
+		{
+			FA_LOG("loading boxes ...");
+			se->loadBoxDb(boxDbFile);
 		}
-*/
 
 		FA_LOG("compiling to microcode ...");
 		se->compile(stor, *main);
@@ -144,6 +125,12 @@ void clEasyRun(const CodeStorage::Storage& stor, const char* configString)
 		{
 			FA_LOG("starting symbolic execution ...");
 			se->run();
+
+			if (!boxDbFile.empty())
+			{
+				FA_LOG("saving boxes ...");
+				se->saveBoxDb(boxDbFile);
+			}
 		}
 	}
 	catch (const NotImplementedException& e)
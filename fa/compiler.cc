@@ -35,6 +35,7 @@
 #include <cl/cldebug.hh>
 
 // Forester headers
+#include "config.h"
 #include "programerror.hh"
 #include "notimpl_except.hh"
 #include "symctx.hh"
@@ -1775,6 +1776,9 @@ protected:
 			{	// if no dead variables were killed
 				tmp[i] = assembly_->code_.back();
 			}
+
+			// the peephole pass must keep the successor in place
+			tmp[i]->setTarget();
 		}
 
 		// append the condition test instruction
@@ -2122,6 +2126,204 @@ protected:
 		assembly_->functionIndex_.insert(std::make_pair(&fnc, iter->second));
 	}
 
+	/**
+	 * @brief  Checks whether an instruction may be referenced from elsewhere
+	 *
+	 * An instruction is pinned if it is the target of a jump, a call, or
+	 * a return, or if it is the head of a basic block.  Pinned instructions
+	 * must stay where they are, so that the pointers to them remain valid.
+	 *
+	 * @param[in]  instr  The instruction
+	 * @param[in]  heads  The heads of basic blocks
+	 *
+	 * @returns  @p true if the instruction is pinned, @p false otherwise
+	 */
+	static bool isPinned(const AbstractInstruction* instr,
+		const std::unordered_set<const AbstractInstruction*>& heads)
+	{
+		return instr->isTarget() || heads.count(instr);
+	}
+
+
+	/**
+	 * @brief  Checks whether an instruction does nothing
+	 *
+	 * @param[in]  prev   The preceding instruction in the same sequence (or
+	 *                    @p nullptr)
+	 * @param[in]  instr  The instruction
+	 *
+	 * @returns  @p true if the instruction can be dropped, @p false otherwise
+	 */
+	static bool isRedundant(const AbstractInstruction* prev,
+		const AbstractInstruction* instr)
+	{
+		if (auto mov = dynamic_cast<const FI_move_reg*>(instr))
+		{	// mov rX, rX
+			return mov->getDst() == mov->getSrc();
+		}
+
+		if (!prev)
+			return false;
+
+		if (instr->getType() == fi_type_e::fiCheck)
+		{	// nothing has changed since the previous check
+			return prev->getType() == fi_type_e::fiCheck;
+		}
+
+		auto acc = dynamic_cast<const FI_acc_sel*>(instr);
+		auto prevAcc = dynamic_cast<const FI_acc_sel*>(prev);
+		if (acc && prevAcc)
+		{	// the selector has just been isolated
+			return (acc->getDst() == prevAcc->getDst()) &&
+				(acc->getOffset() == prevAcc->getOffset());
+		}
+
+		return false;
+	}
+
+
+	/**
+	 * @brief  Fuses a pair of adjacent instructions into a superinstruction
+	 *
+	 * @param[in]  first   The first instruction
+	 * @param[in]  second  The instruction that follows @p first
+	 *
+	 * @returns  The superinstruction, or @p nullptr if the pair cannot be fused
+	 */
+	static AbstractInstruction* fuse(const AbstractInstruction* first,
+		const AbstractInstruction* second)
+	{
+		if (first->insn() != second->insn())
+			return nullptr;
+
+		if (auto acc = dynamic_cast<const FI_acc_sel*>(first))
+		{
+			const int offset = static_cast<int>(acc->getOffset());
+
+			auto load = dynamic_cast<const FI_load*>(second);
+			if (load && (load->getSrc() == acc->getDst()) &&
+				(load->getOffset() == offset))
+			{	// acc [rX + o]; mov rY, [rX + o]
+				return new FI_acc_load(first->insn(), load->getDst(),
+					load->getSrc(), offset);
+			}
+
+			auto store = dynamic_cast<const FI_store*>(second);
+			if (store && (store->getDst() == acc->getDst()) &&
+				(store->getOffset() == offset))
+			{	// acc [rX + o]; mov [rX + o], rY
+				return new FI_acc_store(first->insn(), store->getDst(),
+					store->getSrc(), offset);
+			}
+
+			return nullptr;
+		}
+
+		if (auto abp = dynamic_cast<const FI_get_ABP*>(first))
+		{
+			auto store = dynamic_cast<const FI_store*>(second);
+			if (store && (store->getDst() == abp->getDst()))
+			{	// mov rX, ABP + b; mov [rX + o], rY
+				return new FI_store_ABP(first->insn(), abp->getDst(),
+					abp->getOffset(), store->getSrc(), store->getOffset());
+			}
+		}
+
+		return nullptr;
+	}
+
+
+	/**
+	 * @brief  The peephole pass over the assembly
+	 *
+	 * Drops instructions that do nothing and fuses common pairs of adjacent
+	 * instructions into superinstructions, so that less symbolic states are
+	 * created per an instruction of the code storage.  The pass needs to run
+	 * before the code is finalised, i.e. while jumps still refer to blocks.
+	 */
+	void optimize()
+	{
+		std::unordered_set<const AbstractInstruction*> heads;
+		for (auto blockInstrPair : codeIndex_)
+			heads.insert(blockInstrPair.second);
+
+		// superinstructions that replaced block heads
+		std::unordered_map<const AbstractInstruction*, AbstractInstruction*> moved;
+
+		Compiler::Assembly::CodeList& code = assembly_->code_;
+		Compiler::Assembly::CodeList out;
+		out.reserve(code.size());
+
+		// the preceding instruction if it falls through to the current one
+		const AbstractInstruction* prev = nullptr;
+
+		for (size_t i = 0; i < code.size(); ++i)
+		{
+			AbstractInstruction* instr = code[i];
+
+			if (isPinned(instr, heads))
+				prev = nullptr;
+
+			if (!isPinned(instr, heads) && isRedundant(prev, instr))
+			{
+				delete instr;
+				++assembly_->cntPeepholeDropped_;
+				continue;
+			}
+
+			if ((i + 1 < code.size()) && !instr->isTarget() &&
+				!isPinned(code[i + 1], heads))
+			{
+				AbstractInstruction* super = fuse(instr, code[i + 1]);
+				if (super)
+				{
+					if (heads.count(instr))
+						moved.insert(std::make_pair(instr, super));
+
+					delete instr;
+					delete code[++i];
+					instr = super;
+					++assembly_->cntPeepholeFused_;
+				}
+			}
+
+			out.push_back(instr);
+
+			switch (instr->getType())
+			{
+				case fi_type_e::fiAbort:
+				case fi_type_e::fiBranch:
+				case fi_type_e::fiJump:
+					prev = nullptr;
+					break;
+
+				default:
+					prev = instr;
+					break;
+			}
+		}
+
+		code.swap(out);
+
+		if (moved.empty())
+			return;
+
+		for (auto& blockInstrPair : codeIndex_)
+		{	// update heads of blocks that have been fused
+			auto iter = moved.find(blockInstrPair.second);
+			if (moved.end() != iter)
+				blockInstrPair.second = iter->second;
+		}
+
+		for (auto& fncInstrPair : assembly_->functionIndex_)
+		{	// update entry points of functions
+			auto iter = moved.find(fncInstrPair.second);
+			if (moved.end() != iter)
+				fncInstrPair.second = iter->second;
+		}
+	}
+
+
 	/**
 	 * @brief  Compiles initialisation
 	 *
@@ -2378,6 +2580,10 @@ public:
 				compileFunction(*fnc);
 		}
 
+#if FA_PEEPHOLE_ENABLED
+		optimize();
+#endif
+
 		for (auto i = assembly_->code_.begin(); i != assembly_->code_.end(); ++i)
 		{	// finalize all microinstructions
 			(*i)->finalize(codeIndex_, i);
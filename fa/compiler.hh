@@ -86,6 +86,12 @@ public:
 		/// size of the register file
 		size_t regFileSize_;
 
+		/// number of instructions dropped by the peephole pass
+		size_t cntPeepholeDropped_;
+
+		/// number of superinstructions created by the peephole pass
+		size_t cntPeepholeFused_;
+
 
 		/**
 		 * @brief  Default constructor
@@ -93,7 +99,9 @@ public:
 		Assembly() :
 			code_{},
 			functionIndex_{},
-			regFileSize_{}
+			regFileSize_{},
+			cntPeepholeDropped_{},
+			cntPeepholeFused_{}
 		{ }
 
 
@@ -114,6 +122,8 @@ public:
 			code_.clear();
 			functionIndex_.clear();
 			regFileSize_ = 0;
+			cntPeepholeDropped_ = 0;
+			cntPeepholeFused_ = 0;
 		}
 
 
@@ -60,4 +60,9 @@
  */
 #define FA_FUSION_ENABLED					1
 
+/**
+ * run the peephole pass over the compiled microcode (default is 1)
+ */
+#define FA_PEEPHOLE_ENABLED					1
+
 #endif /* CONFIG_H */
@@ -20,6 +20,9 @@
 // Forester headers
 #include "connection_graph.hh"
 
+size_t ConnectionGraph::cntComputed = 0;
+size_t ConnectionGraph::cntReused = 0;
+
 void ConnectionGraph::updateStateSignature(
 	StateToCutpointSignatureMap& stateMap, size_t state,
 	const CutpointSignature& v)
@@ -455,6 +458,9 @@ void ConnectionGraph::mergeCutpoint(size_t dst, size_t src)
 	ConnectionGraph::normalizeSignature(signature);
 
 	std::swap(this->data[dst].signature, signature);
+
+	// the merged signature no longer belongs to the original automaton
+	this->data[dst].ta.reset();
 }
 
 void ConnectionGraph::normalizeSignature(CutpointSignature& signature)
@@ -636,14 +642,16 @@ size_t ConnectionGraph::climb(size_t c, const std::vector<bool>& visited,
 }
 
 
-void ConnectionGraph::finishNormalization(size_t size, const std::vector<size_t>& index)
+void ConnectionGraph::finishNormalization(
+	const std::vector<std::shared_ptr<TreeAut>>& roots,
+	const std::vector<size_t>& index)
 {
 	// Assertions
-	assert(size <= this->data.size());
+	assert(roots.size() <= this->data.size());
 	assert(index.size() == this->data.size());
 	assert(this->isValid());
 
-	ConnectionData tmp(size);
+	ConnectionData tmp(roots.size());
 
 	for (size_t i = 0; i < this->data.size(); ++i)
 	{
@@ -657,12 +665,17 @@ void ConnectionGraph::finishNormalization(size_t size, const std::vector<size_t>
 
 	std::swap(tmp, this->data);
 
-	for (auto& root : this->data)
+	for (size_t i = 0; i < this->data.size(); ++i)
 	{
+		RootInfo& root = this->data[i];
+
 		assert(root.valid);
 
 		ConnectionGraph::renameSignature(root.signature, index);
 
+		// the renamed signature belongs to the relabelled automaton
+		root.ta = roots[i];
+
 		for (auto& selectorRootPair : root.bwdMap)
 		{
 			assert(selectorRootPair.second < index.size());
@@ -684,6 +697,8 @@ void ConnectionGraph::updateRoot(size_t root, const TreeAut& ta)
 
 	ConnectionGraph::computeSignatures(stateMap, ta);
 
+	++ConnectionGraph::cntComputed;
+
 	auto iter = ta.getFinalStates().begin();
 
 	assert(stateMap.find(*iter) != stateMap.end());
@@ -764,11 +779,23 @@ void ConnectionGraph::updateIfNeeded(const std::vector<std::shared_ptr<TreeAut>>
 		if (!roots[i])
 		{
 			this->data[i].valid = true;
+			this->data[i].ta.reset();
+
+			continue;
+		}
+
+		if (this->data[i].ta.lock() == roots[i])
+		{	// the automaton has not changed since the signature was computed
+			++ConnectionGraph::cntReused;
+
+			this->updateBackwardData(i);
 
 			continue;
 		}
 
 		this->updateRoot(i, *roots[i]);
+
+		this->data[i].ta = roots[i];
 	}
 }
 
@@ -167,7 +167,10 @@ public:
 		CutpointSignature signature;
 		std::map<size_t, size_t> bwdMap;
 
-		RootInfo() : valid(), signature(), bwdMap() {}
+		/// the automaton the signature was computed from (kept on invalidation)
+		std::weak_ptr<const TreeAut> ta;
+
+		RootInfo() : valid(), signature(), bwdMap(), ta() {}
 
 		size_t backwardLookup(size_t selector) const
 		{
@@ -306,7 +309,8 @@ public:
 		return ConnectionGraph::containsCutpoint(this->data[root].signature, target);
 	}
 
-	void finishNormalization(size_t size, const std::vector<size_t>& index);
+	void finishNormalization(const std::vector<std::shared_ptr<TreeAut>>& roots,
+		const std::vector<size_t>& index);
 
 	void mergeCutpoint(size_t dst, size_t src);
 
@@ -320,6 +324,14 @@ public:
 
 	void visit(size_t c, std::vector<bool>& visited) const;
 
+public:
+
+	/// number of signatures computed from scratch (over all connection graphs)
+	static size_t cntComputed;
+
+	/// number of invalidated signatures restored without a recomputation
+	static size_t cntReused;
+
 public:
 
 	ConnectionGraph(size_t size = 0) : data(size) {}
@@ -23,11 +23,15 @@
 // Standard library headers
 #include <list>
 
+// Code Listener headers
+#include <cl/storage.hh>
+
 // Forester headers
 #include "types.hh"
 #include "recycler.hh"
 #include "abstractinstruction.hh"
 #include "fixpointinstruction.hh"
+#include "programerror.hh"
 #include "symstate.hh"
 
 
@@ -52,6 +56,12 @@ private:  // data members
 	/// counter of evaluated paths
 	size_t pathsEvaluated_;
 
+	/// should register-only instructions be executed in place?
+	bool inPlace_;
+
+	/// counter of instructions executed in place
+	size_t instrsInPlace_;
+
 	/// memory manager for registers
 	Recycler<DataArray> registerRecycler_;
 	/// memory manager for states
@@ -87,6 +97,8 @@ public:
 		queue_{},
 		statesExecuted_{},
 		pathsEvaluated_{},
+		inPlace_(true),
+		instrsInPlace_{},
 		registerRecycler_{},
 		stateRecycler_{}
 	{ }
@@ -100,6 +112,61 @@ public:
 
 	size_t pathsEvaluated() const { return pathsEvaluated_; }
 
+	size_t instrsInPlace() const { return instrsInPlace_; }
+
+	/**
+	 * @brief  Enables or disables the execution of instructions in place
+	 *
+	 * Instructions executed in place do not appear in the trace, so this needs
+	 * to be disabled if the full trace is required.
+	 *
+	 * @param[in]  enable  @p true to enable the execution in place
+	 */
+	void setInPlace(bool enable) { inPlace_ = enable; }
+
+	/**
+	 * @brief  Runs a sequence of register-only instructions in place
+	 *
+	 * Executes the instructions starting at @p instr directly on the given
+	 * registers as long as they are deterministic and modify only the
+	 * registers (see AbstractInstruction::executeInPlace()).
+	 *
+	 * @param[in,out]  regs   The registers, updated in place
+	 * @param[in]      fae    The forest automaton the registers belong to
+	 * @param[in]      instr  The first instruction of the sequence
+	 *
+	 * @returns  The first instruction that needs a symbolic state of its own
+	 */
+	AbstractInstruction* runInPlace(DataArray& regs, const FAE& fae,
+		AbstractInstruction* instr)
+	{
+		if (!inPlace_)
+			return instr;
+
+		try
+		{
+			while (AbstractInstruction* next = instr->executeInPlace(regs, fae))
+			{
+				++instrsInPlace_;
+				instr = next;
+			}
+		}
+		catch (const ProgramError& e)
+		{	// the error would be otherwise attributed to the instruction of the
+			// state being executed
+			if (e.instr())
+				throw;
+
+			const cl_loc* loc = e.location();
+			if (!loc && instr->insn())
+				loc = &instr->insn()->loc;
+
+			throw ProgramError(e.what(), loc, e.state(), instr);
+		}
+
+		return instr;
+	}
+
 	void clear()
 	{
 		if (root_)
@@ -112,11 +179,14 @@ public:
 
 		statesExecuted_ = 0;
 		pathsEvaluated_ = 0;
+		instrsInPlace_ = 0;
 	}
 
 	SymState* enqueue(SymState* parent, const std::shared_ptr<DataArray>& registers,
 		const std::shared_ptr<const FAE>& fae, AbstractInstruction* instr)
 	{
+		instr = this->runInPlace(*registers, *fae, instr);
+
 		SymState* state = stateRecycler_.alloc();
 
 		state->init(
@@ -131,6 +201,9 @@ public:
 
 	SymState* enqueue(const ExecState& parent, AbstractInstruction* instr)
 	{
+		instr = this->runInPlace(*parent.GetRegsShPtr(),
+			*parent.GetMem()->GetFAE(), instr);
+
 		SymState* state = stateRecycler_.alloc();
 
 		state->init(
@@ -143,6 +216,18 @@ public:
 		return state;
 	}
 
+	/**
+	 * @brief  Puts an already dequeued state back to the queue
+	 *
+	 * The state is going to be dequeued next by dequeueDFS().
+	 *
+	 * @param[in]  state  The state to be executed once again
+	 */
+	void requeue(const ExecState& state)
+	{
+		state.GetMem()->SetQueueTag(queue_.insert(queue_.end(), state));
+	}
+
 	bool dequeueBFS(ExecState& state)
 	{
 		if (queue_.empty())
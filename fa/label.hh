@@ -36,6 +36,9 @@ struct NodeLabel {
 
 	node_type type;
 
+	/// unique ID of the label, assigned by BoxMan in the order of creation
+	size_t uid;
+
 	struct NodeItem {
 		const AbstractBox* aBox;
 		size_t index;
@@ -58,9 +61,10 @@ struct NodeLabel {
 		const DataArray* vData;
 	};
 
-	NodeLabel() : type(node_type::n_unknown) {}
+	NodeLabel() : type(node_type::n_unknown), uid(0) {}
 	NodeLabel(const Data* data, size_t id) :
-		type(node_type::n_data)
+		type(node_type::n_data),
+		uid(0)
 	{
 		this->data.data = data;
 		this->data.id = id;
@@ -70,7 +74,8 @@ struct NodeLabel {
 		const std::vector<const AbstractBox*>* v,
 		const std::vector<SelData>* sels
 	) :
-		type(node_type::n_node)
+		type(node_type::n_node),
+		uid(0)
 	{
 		this->node.v = v;
 		this->node.m = new std::unordered_map<size_t, NodeItem>();
@@ -79,6 +84,7 @@ struct NodeLabel {
 
 	NodeLabel(const DataArray* vData) :
 		type(node_type::n_vData),
+		uid(0),
 		vData(vData)
 	{ }
 
@@ -216,8 +222,14 @@ struct label_type {
 		return this->_obj;
 	}
 
+	/// the ID used for ordering and hashing, so that they do not depend on
+	/// the addresses the labels happen to be allocated at
+	size_t id() const {
+		return (this->_obj) ? (this->_obj->uid + 1) : 0;
+	}
+
 	bool operator<(const label_type& rhs) const {
-		return this->_obj < rhs._obj;
+		return this->id() < rhs.id();
 	}
 
 	bool operator==(const label_type& rhs) const {
@@ -229,7 +241,7 @@ struct label_type {
 	}
 
 	friend size_t hash_value(const label_type& label) {
-		return boost::hash_value(label._obj);
+		return boost::hash_value(label.id());
 	}
 
 	friend std::ostream& operator<<(std::ostream& os, const label_type& label) {
@@ -260,7 +272,7 @@ namespace std {
 	template <>
 	struct hash<label_type> {
 		size_t operator()(const label_type& label) const {
-			return boost::hash_value(label._obj);
+			return boost::hash_value(label.id());
 		}
 	};
 
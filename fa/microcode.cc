@@ -52,6 +52,36 @@ inline const cl_loc* getLoc(const ExecState& state)
 	return &(state.GetMem()->GetInstr()->insn()->loc);
 }
 
+inline const cl_loc* getLoc(const AbstractInstruction& instr)
+{
+	if (!instr.insn())
+		return nullptr;
+
+	return &instr.insn()->loc;
+}
+
+/**
+ * @brief  Executes a register-only instruction in a symbolic state
+ *
+ * Used when the instruction has not been executed in place by the execution
+ * manager, e.g. when the execution in place is disabled.
+ *
+ * @param[in]      instr    The instruction
+ * @param[in,out]  execMan  The execution manager
+ * @param[in]      state    The state in which the instruction is executed
+ */
+inline void executeRegOnly(const AbstractInstruction& instr,
+	ExecutionManager& execMan, const ExecState& state)
+{
+	AbstractInstruction* next = instr.executeInPlace(*state.GetRegsShPtr(),
+		*state.GetMem()->GetFAE());
+
+	// Assertions
+	assert(nullptr != next);
+
+	execMan.enqueue(state, next);
+}
+
 } // namespace
 
 // FI_cond
@@ -158,95 +188,127 @@ void FI_acc_all::execute(ExecutionManager& execMan, const ExecState& state)
 }
 
 // FI_load_cst
-void FI_load_cst::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_load_cst::executeInPlace(DataArray& regs,
+	const FAE& /* fae */) const
 {
-	ExecState tmpState = state;
-	tmpState.SetReg(dst_, data_);
+	regs[dst_] = data_;
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_load_cst::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_move_reg
-void FI_move_reg::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_move_reg::executeInPlace(DataArray& regs,
+	const FAE& /* fae */) const
 {
-	ExecState tmpState = state;
-	tmpState.SetReg(dst_, tmpState.GetReg(src_));
+	regs[dst_] = regs[src_];
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_move_reg::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_bnot
-void FI_bnot::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_bnot::executeInPlace(DataArray& regs,
+	const FAE& /* fae */) const
 {
 	// Assertions
-	assert(state.GetReg(dst_).isBool());
+	assert(regs[dst_].isBool());
 
-	ExecState tmpState = state;
+	regs[dst_] = Data::createBool(!regs[dst_].d_bool);
 
-	tmpState.SetReg(dst_, Data::createBool(!tmpState.GetReg(dst_).d_bool));
+	return next_;
+}
 
-	execMan.enqueue(tmpState, next_);
+void FI_bnot::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_inot
-void FI_inot::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_inot::executeInPlace(DataArray& regs,
+	const FAE& /* fae */) const
 {
 	// Assertions
-	assert(state.GetReg(dst_).isInt());
+	assert(regs[dst_].isInt());
 
-	ExecState tmpState = state;
+	regs[dst_] = Data::createBool(!regs[dst_].d_int);
 
-	tmpState.SetReg(dst_, Data::createBool(!tmpState.GetReg(dst_).d_int));
+	return next_;
+}
 
-	execMan.enqueue(tmpState, next_);
+void FI_inot::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_move_reg_offs
-void FI_move_reg_offs::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_move_reg_offs::executeInPlace(DataArray& regs,
+	const FAE& /* fae */) const
 {
-	ExecState tmpState = state;
-	Data data = tmpState.GetReg(src_);
+	Data data = regs[src_];
 
 	if (!data.isRef())
 	{
 		std::stringstream ss;
 		ss << "dereferenced value is not a valid reference [" << data << ']';
-		throw ProgramError(ss.str(), getLoc(tmpState));
+		throw ProgramError(ss.str(), getLoc(*this));
 	}
 
 	data.d_ref.displ += offset_;
 
-	tmpState.SetReg(dst_, data);
+	regs[dst_] = data;
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_move_reg_offs::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_move_reg_inc
-void FI_move_reg_inc::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_move_reg_inc::executeInPlace(DataArray& regs,
+	const FAE& /* fae */) const
 {
-	ExecState tmpState = state;
-	Data data = tmpState.GetReg(src1_);
+	Data data = regs[src1_];
 
 	if (!data.isRef())
 	{
 		std::stringstream ss;
 		ss << "dereferenced value is not a valid reference [" << data << ']';
-		throw ProgramError(ss.str(), getLoc(tmpState));
+		throw ProgramError(ss.str(), getLoc(*this));
 	}
 
-	data.d_ref.displ += tmpState.GetReg(src2_).d_int;
-	tmpState.SetReg(dst_, data);
+	data.d_ref.displ += regs[src2_].d_int;
+	regs[dst_] = data;
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_move_reg_inc::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_get_greg
-void FI_get_greg::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_get_greg::executeInPlace(DataArray& regs, const FAE& fae) const
 {
-	ExecState tmpState = state;
-	tmpState.SetReg(dst_, VirtualMachine(*tmpState.GetMem()->GetFAE()).varGet(src_));
+	regs[dst_] = VirtualMachine(fae).varGet(src_);
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_get_greg::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_set_greg
@@ -258,74 +320,94 @@ void FI_set_greg::execute(ExecutionManager& execMan, const ExecState& state)
 }
 
 // FI_get_ABP
-void FI_get_ABP::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_get_ABP::executeInPlace(DataArray& regs, const FAE& fae) const
 {
-	ExecState tmpState = state;
-	Data data = VirtualMachine(*tmpState.GetMem()->GetFAE()).varGet(ABP_INDEX);
+	Data data = VirtualMachine(fae).varGet(ABP_INDEX);
 	data.d_ref.displ += offset_;
 
-	tmpState.SetReg(dst_, data);
+	regs[dst_] = data;
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_get_ABP::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_get_GLOB
-void FI_get_GLOB::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_get_GLOB::executeInPlace(DataArray& regs, const FAE& fae) const
 {
-	ExecState tmpState = state;
-	Data data = VirtualMachine(*tmpState.GetMem()->GetFAE()).varGet(GLOB_INDEX);
+	Data data = VirtualMachine(fae).varGet(GLOB_INDEX);
 	data.d_ref.displ += offset_;
 
-	tmpState.SetReg(dst_, data);
+	regs[dst_] = data;
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_get_GLOB::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_load
-void FI_load::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_load::executeInPlace(DataArray& regs, const FAE& fae) const
 {
 	// Assertions
-	assert(state.GetReg(src_).isRef());
-
-	ExecState tmpState = state;
+	assert(regs[src_].isRef());
 
-	Data data = tmpState.GetReg(src_);
+	const Data data = regs[src_];
 	Data out;
 
-	VirtualMachine(*tmpState.GetMem()->GetFAE()).nodeLookup(
+	VirtualMachine(fae).nodeLookup(
 		data.d_ref.root, data.d_ref.displ + offset_, out
 	);
 
-	tmpState.SetReg(dst_, out);
+	regs[dst_] = out;
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_load::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_load_ABP
-void FI_load_ABP::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_load_ABP::executeInPlace(DataArray& regs, const FAE& fae) const
 {
-	ExecState tmpState = state;
-	VirtualMachine vm(*tmpState.GetMem()->GetFAE());
+	VirtualMachine vm(fae);
 
-	Data data = vm.varGet(ABP_INDEX);
+	const Data& data = vm.varGet(ABP_INDEX);
 	Data out;
 	vm.nodeLookup(data.d_ref.root, static_cast<size_t>(offset_), out);
-	tmpState.SetReg(dst_, out);
-	execMan.enqueue(tmpState, next_);
+	regs[dst_] = out;
+
+	return next_;
+}
+
+void FI_load_ABP::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_load_GLOB
-void FI_load_GLOB::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_load_GLOB::executeInPlace(DataArray& regs, const FAE& fae) const
 {
-	ExecState tmpState = state;
-	VirtualMachine vm(*tmpState.GetMem()->GetFAE());
+	VirtualMachine vm(fae);
 
-	Data data = vm.varGet(GLOB_INDEX);
+	const Data& data = vm.varGet(GLOB_INDEX);
 	Data out;
 	vm.nodeLookup(data.d_ref.root, static_cast<size_t>(offset_), out);
-	tmpState.SetReg(dst_, out);
+	regs[dst_] = out;
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_load_GLOB::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_store
@@ -348,23 +430,111 @@ void FI_store::execute(ExecutionManager& execMan, const ExecState& state)
 	execMan.enqueue(state.GetMem(), state.GetRegsShPtr(), fae, next_);
 }
 
+// FI_acc_load
+void FI_acc_load::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	const Data data = state.GetReg(src_);
+
+	if (!data.isRef())
+	{
+		std::stringstream ss;
+		ss << "dereferenced value is not a valid reference [" << data << ']';
+		throw ProgramError(ss.str(), getLoc(state));
+	}
+
+	std::vector<FAE*> dst;
+
+	Splitting(*state.GetMem()->GetFAE()).isolateOne(dst, data.d_ref.root,
+		data.d_ref.displ + offset_);
+
+	for (auto fae : dst)
+	{	// load the selector directly from each of the isolated heaps
+		std::shared_ptr<const FAE> faePtr(fae);
+		std::shared_ptr<DataArray> regs = execMan.allocRegisters(state.GetRegs());
+
+		VirtualMachine(*faePtr).nodeLookup(
+			data.d_ref.root, data.d_ref.displ + offset_, (*regs)[dst_]
+		);
+
+		execMan.enqueue(state.GetMem(), regs, faePtr, next_);
+	}
+}
+
+// FI_acc_store
+void FI_acc_store::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	const Data data = state.GetReg(dst_);
+
+	if (!data.isRef())
+	{
+		std::stringstream ss;
+		ss << "dereferenced value is not a valid reference [" << data << ']';
+		throw ProgramError(ss.str(), getLoc(state));
+	}
+
+	std::vector<FAE*> dst;
+
+	Splitting(*state.GetMem()->GetFAE()).isolateOne(dst, data.d_ref.root,
+		data.d_ref.displ + offset_);
+
+	for (auto fae : dst)
+	{	// the isolated heaps are not shared yet, so they can be modified in place
+		std::shared_ptr<FAE> faePtr(fae);
+
+		Data out;
+
+		VirtualMachine(*faePtr).nodeModify(
+			data.d_ref.root, data.d_ref.displ + offset_, state.GetReg(src_), out
+		);
+
+		execMan.enqueue(state.GetMem(), execMan.allocRegisters(state.GetRegs()),
+			faePtr, next_);
+	}
+}
+
+// FI_store_ABP
+void FI_store_ABP::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	ExecState tmpState = state;
+
+	std::shared_ptr<FAE> fae = std::shared_ptr<FAE>(new FAE(*state.GetMem()->GetFAE()));
+	VirtualMachine vm(*fae);
+
+	Data dst = vm.varGet(ABP_INDEX);
+	dst.d_ref.displ += base_;
+
+	tmpState.SetReg(dst_, dst);
+
+	Data out;
+
+	vm.nodeModify(dst.d_ref.root, dst.d_ref.displ + offset_,
+		tmpState.GetReg(src_), out);
+
+	execMan.enqueue(state.GetMem(), tmpState.GetRegsShPtr(), fae, next_);
+}
+
 // FI_loads
-void FI_loads::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_loads::executeInPlace(DataArray& regs, const FAE& fae) const
 {
 	// Assertions
-	assert(state.GetReg(src_).isRef());
+	assert(regs[src_].isRef());
 
-	ExecState tmpState = state;
-	Data data = tmpState.GetReg(src_);
+	const Data data = regs[src_];
 	Data out;
 
-	VirtualMachine(*state.GetMem()->GetFAE()).nodeLookupMultiple(
+	VirtualMachine(fae).nodeLookupMultiple(
 		data.d_ref.root, data.d_ref.displ + base_, offsets_,
 		out
 	);
 
-	tmpState.SetReg(dst_, out);
-	execMan.enqueue(tmpState, next_);
+	regs[dst_] = out;
+
+	return next_;
+}
+
+void FI_loads::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_stores
@@ -473,19 +643,22 @@ void FI_node_free::execute(ExecutionManager& execMan, const ExecState& state)
 }
 
 // FI_iadd
-void FI_iadd::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_iadd::executeInPlace(DataArray& regs,
+	const FAE& /* fae */) const
 {
 	// Assertions
-	assert(state.GetReg(src1_).isInt() && state.GetReg(src2_).isInt());
+	assert(regs[src1_].isInt() && regs[src2_].isInt());
 
-	ExecState tmpState = state;
-	tmpState.SetReg(dst_,
-		Data::createInt(
-			(tmpState.GetReg(src1_).d_int + tmpState.GetReg(src2_).d_int > 0)?(1):(0)
-		)
+	regs[dst_] = Data::createInt(
+		(regs[src1_].d_int + regs[src2_].d_int > 0)?(1):(0)
 	);
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_iadd::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_check
@@ -519,20 +692,24 @@ void FI_abort::execute(ExecutionManager& execMan, const ExecState& state)
 }
 
 // FI_build_struct
-void FI_build_struct::execute(ExecutionManager& execMan, const ExecState& state)
+AbstractInstruction* FI_build_struct::executeInPlace(DataArray& regs,
+	const FAE& /* fae */) const
 {
-	ExecState tmpState = state;
-
 	std::vector<Data::item_info> items;
 
 	for (size_t i = 0; i < offsets_.size(); ++i)
 	{
-		items.push_back(std::make_pair(offsets_[i], tmpState.GetReg(start_ + i)));
+		items.push_back(std::make_pair(offsets_[i], regs[start_ + i]));
 	}
 
-	tmpState.SetReg(dst_, Data::createStruct(items));
+	regs[dst_] = Data::createStruct(items);
 
-	execMan.enqueue(tmpState, next_);
+	return next_;
+}
+
+void FI_build_struct::execute(ExecutionManager& execMan, const ExecState& state)
+{
+	executeRegOnly(*this, execMan, state);
 }
 
 // FI_push_greg
@@ -83,6 +83,9 @@ public:
 
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
+	size_t getDst() const { return dst_; }
+	size_t getOffset() const { return offset_; }
+
 	virtual std::ostream& toStream(std::ostream& os) const {
 		return os << "acc   \t[r" << this->dst_ << " + " << this->offset_ << "]";
 	}
@@ -137,6 +140,9 @@ public:
 	FI_load_cst(const CodeStorage::Insn* insn, size_t dst, const Data& data)
 		: SequentialInstruction(insn), dst_(dst), data_(data) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -155,8 +161,14 @@ public:
 	FI_move_reg(const CodeStorage::Insn* insn, size_t dst, size_t src)
 		: SequentialInstruction(insn), dst_(dst), src_(src) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
+	size_t getDst() const { return dst_; }
+	size_t getSrc() const { return src_; }
+
 	virtual std::ostream& toStream(std::ostream& os) const {
 		return os << "mov   \tr" << this->dst_ << ", r" << this->src_;
 	}
@@ -172,6 +184,9 @@ public:
 	FI_bnot(const CodeStorage::Insn* insn, size_t dst)
 		: SequentialInstruction(insn), dst_(dst) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -189,6 +204,9 @@ public:
 	FI_inot(const CodeStorage::Insn* insn, size_t dst) :
 		SequentialInstruction(insn), dst_(dst) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -209,6 +227,9 @@ public:
 		size_t dst, size_t src, int offset)
 		: SequentialInstruction(insn), dst_(dst), src_(src), offset_(offset) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -230,6 +251,9 @@ public:
 		size_t dst, size_t src1, size_t src2)
 		: SequentialInstruction(insn), dst_(dst), src1_(src1), src2_(src2) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -249,6 +273,9 @@ public:
 	FI_get_greg(const CodeStorage::Insn* insn, size_t dst, size_t src)
 		: SequentialInstruction(insn), dst_(dst), src_(src) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -285,8 +312,14 @@ public:
 	FI_get_ABP(const CodeStorage::Insn* insn, size_t dst, int offset)
 		: SequentialInstruction(insn), dst_(dst), offset_(offset) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
+	size_t getDst() const { return dst_; }
+	int getOffset() const { return offset_; }
+
 	virtual std::ostream& toStream(std::ostream& os) const {
 		return os << "mov   \tr" << this->dst_ << ", ABP + " << this->offset_;
 	}
@@ -303,6 +336,9 @@ public:
 	FI_get_GLOB(const CodeStorage::Insn* insn, size_t dst, int offset)
 		: SequentialInstruction(insn), dst_(dst), offset_(offset) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -412,8 +448,15 @@ public:
 	FI_load(const CodeStorage::Insn* insn, size_t dst, size_t src, int offset)
 		: SequentialInstruction(insn), dst_(dst), src_(src), offset_(offset) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
+	size_t getDst() const { return dst_; }
+	size_t getSrc() const { return src_; }
+	int getOffset() const { return offset_; }
+
 	virtual std::ostream& toStream(std::ostream& os) const {
 		return os << "mov   \tr" << this->dst_ << ", [r" << this->src_
 			<< " + " << this->offset_ << ']';
@@ -431,6 +474,9 @@ public:
 	FI_load_ABP(const CodeStorage::Insn* insn, size_t dst, int offset)
 		: SequentialInstruction(insn), dst_(dst), offset_(offset) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -449,6 +495,9 @@ public:
 	FI_load_GLOB(const CodeStorage::Insn* insn, size_t dst, int offset)
 		: SequentialInstruction(insn), dst_(dst), offset_(offset) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -470,6 +519,10 @@ public:
 
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
+	size_t getDst() const { return dst_; }
+	size_t getSrc() const { return src_; }
+	int getOffset() const { return offset_; }
+
 	virtual std::ostream& toStream(std::ostream& os) const {
 		return os << "mov   \t[r" << this->dst_ << " + " << this->offset_
 			<< "], r" << this->src_;
@@ -477,6 +530,78 @@ public:
 
 };
 
+// superinstructions produced by the peephole pass of the compiler, each of
+// them does the job of a sequence of microinstructions in a single step
+
+// acc [r(src) + offset]; mov r(dst), [r(src) + offset]
+class FI_acc_load : public SequentialInstruction {
+
+	size_t dst_;
+	size_t src_;
+	int offset_;
+
+public:
+
+	FI_acc_load(const CodeStorage::Insn* insn, size_t dst, size_t src, int offset)
+		: SequentialInstruction(insn), dst_(dst), src_(src), offset_(offset) {}
+
+	virtual void execute(ExecutionManager& execMan, const ExecState& state);
+
+	virtual std::ostream& toStream(std::ostream& os) const {
+		return os << "acc   \t[r" << this->src_ << " + " << this->offset_
+			<< "]; mov r" << this->dst_ << ", [r" << this->src_ << " + "
+			<< this->offset_ << ']';
+	}
+
+};
+
+// acc [r(dst) + offset]; mov [r(dst) + offset], r(src)
+class FI_acc_store : public SequentialInstruction {
+
+	size_t dst_;
+	size_t src_;
+	int offset_;
+
+public:
+
+	FI_acc_store(const CodeStorage::Insn* insn, size_t dst, size_t src, int offset)
+		: SequentialInstruction(insn), dst_(dst), src_(src), offset_(offset) {}
+
+	virtual void execute(ExecutionManager& execMan, const ExecState& state);
+
+	virtual std::ostream& toStream(std::ostream& os) const {
+		return os << "acc   \t[r" << this->dst_ << " + " << this->offset_
+			<< "]; mov [r" << this->dst_ << " + " << this->offset_ << "], r"
+			<< this->src_;
+	}
+
+};
+
+// mov r(dst), ABP + base; mov [r(dst) + offset], r(src)
+class FI_store_ABP : public SequentialInstruction {
+
+	size_t dst_;
+	int base_;
+	size_t src_;
+	int offset_;
+
+public:
+
+	FI_store_ABP(const CodeStorage::Insn* insn, size_t dst, int base, size_t src,
+		int offset)
+		: SequentialInstruction(insn), dst_(dst), base_(base), src_(src),
+		offset_(offset) {}
+
+	virtual void execute(ExecutionManager& execMan, const ExecState& state);
+
+	virtual std::ostream& toStream(std::ostream& os) const {
+		return os << "mov   \tr" << this->dst_ << ", ABP + " << this->base_
+			<< "; mov [r" << this->dst_ << " + " << this->offset_ << "], r"
+			<< this->src_;
+	}
+
+};
+
 class FI_loads : public SequentialInstruction {
 
 	size_t dst_;
@@ -491,6 +616,9 @@ public:
 		: SequentialInstruction(insn), dst_(dst), src_(src), base_(base),
 		offsets_(offsets) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -619,6 +747,9 @@ public:
 	FI_iadd(const CodeStorage::Insn* insn, size_t dst, size_t src1, size_t src2)
 		: SequentialInstruction(insn), dst_(dst), src1_(src1), src2_(src2) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
@@ -698,6 +829,9 @@ public:
 		const std::vector<size_t>& offsets)
 		: SequentialInstruction(insn), dst_(dst), start_(start), offsets_(offsets) {}
 
+	virtual AbstractInstruction* executeInPlace(DataArray& regs,
+		const FAE& fae) const;
+
 	virtual void execute(ExecutionManager& execMan, const ExecState& state);
 
 	virtual std::ostream& toStream(std::ostream& os) const {
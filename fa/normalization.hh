@@ -328,7 +328,7 @@ public:
 
 		}
 
-		this->fae.connectionGraph.finishNormalization(this->fae.roots.size(), index);
+		this->fae.connectionGraph.finishNormalization(this->fae.roots, index);
 
 		// update variables
 		this->fae.UpdateVarsRootRefs(index);
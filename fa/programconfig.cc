@@ -64,6 +64,13 @@ void ProgramConfig::processArg(const std::string& arg)
 		return;
 	}
 
+	if (std::string("incremental-restart") == key)
+	{
+		this->incrRestart = true;
+		FA_LOG("Config::processArg: \"incremental-restart\" mode requested");
+		return;
+	}
+
 	//      ***************  binary arguments ****************
 	if (std::string("db-root") == key)
 	{
@@ -35,6 +35,7 @@ public:   // data members
 	bool        onlyCompile;        ///< only compiling?
 	bool        printTrace;         ///< printing trace for errors?
 	bool        printUcodeTrace;    ///< printing microcode trace for errors?
+	bool        incrRestart;        ///< invalidate only affected fixpoints?
 
 private:  // methods
 
@@ -47,7 +48,8 @@ public:   // methods
 		printUcode(false),
 		onlyCompile(false),
 		printTrace(false),
-		printUcodeTrace(false)
+		printUcodeTrace(false),
+		incrRestart(false)
 	{
 		std::vector<std::string> args;
 		boost::split(args, confStr, boost::is_any_of(";"));
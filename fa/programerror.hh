@@ -36,6 +36,7 @@
  * ProgramError class declaration (and definition)
  */
 
+class AbstractInstruction;
 class SymState;
 
 /**
@@ -56,6 +57,9 @@ class ProgramError : public std::exception
 	/// The state in which the error appeared
 	const SymState* state_;
 
+	/// The instruction executed in place that caused the error (if any)
+	const AbstractInstruction* instr_;
+
 public:
 
 	/**
@@ -66,21 +70,25 @@ public:
 	 * @param[in]  msg    The error message
 	 * @param[in]  loc    The location in the program that caused the error
 	 * @param[in]  state  State in which the error appeared
+	 * @param[in]  instr  Instruction executed in place that caused the error
+	 *                    (@p nullptr if it is the instruction of @p state)
 	 */
 	ProgramError(
-		const std::string&  msg = "",
-		const cl_loc*       loc = nullptr,
-		const SymState*     state = nullptr) :
+		const std::string&          msg = "",
+		const cl_loc*               loc = nullptr,
+		const SymState*             state = nullptr,
+		const AbstractInstruction*  instr = nullptr) :
 		msg_(msg),
 		loc_(loc),
-		state_(state)
+		state_(state),
+		instr_(instr)
 	{ }
 
 	/**
 	 * @brief  Copy constructor
 	 */
 	ProgramError(const ProgramError& err) :
-		msg_{err.msg_}, loc_{err.loc_}, state_{err.state_}
+		msg_{err.msg_}, loc_{err.loc_}, state_{err.state_}, instr_{err.instr_}
 	{ }
 
 	/**
@@ -93,6 +101,7 @@ public:
 			msg_   = err.msg_;
 			loc_   = err.loc_;
 			state_ = err.state_;
+			instr_ = err.instr_;
 		}
 
 		return *this;
@@ -132,6 +141,18 @@ public:
 	 * @returns  The state in which the error occured
 	 */
 	const SymState* state() const throw() { return state_; }
+
+	/**
+	 * @brief  Instruction executed in place that caused the error
+	 *
+	 * Instructions executed in place (see
+	 * ExecutionManager::runInPlace()) do not have a symbolic state of their
+	 * own, so the error is caught in a state of a different instruction.
+	 *
+	 * @returns  The instruction, or @p nullptr if the error was caused by the
+	 *           instruction of the state being executed
+	 */
+	const AbstractInstruction* instr() const throw() { return instr_; }
 };
 
 #endif
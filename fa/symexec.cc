@@ -36,6 +36,7 @@ void reportErrorNoLocation(const char* errMsg)
 
 
 // Standard library headers
+#include <map>
 #include <sstream>
 #include <vector>
 #include <list>
@@ -50,6 +51,7 @@ void reportErrorNoLocation(const char* errMsg)
 #include "../cl/ssd.h"
 
 // Forester headers
+#include "boxdb.hh"
 #include "forestautext.hh"
 #include "symctx.hh"
 #include "executionmanager.hh"
@@ -165,6 +167,7 @@ private:  // data members
 	TreeAut::Backend taBackend_;
 	TreeAut::Backend fixpointBackend_;
 	BoxMan boxMan_;
+	BoxDb boxDb_;
 
 	Compiler compiler_;
 	Compiler::Assembly assembly_;
@@ -176,6 +179,18 @@ private:  // data members
 	volatile bool dbgFlag_;
 	volatile bool userRequestFlag_;
 
+	/// fixpoints reached from the given fixpoint without passing another one
+	std::map<const AbstractInstruction*, std::set<AbstractInstruction*>> fixDeps_;
+
+	/// count of restarts caused by discovery of a new box
+	size_t cntRestarts_;
+
+	/// count of fixpoints cleared because of a new box
+	size_t cntClearedFixpoints_;
+
+	/// count of states executed once again because of a new box
+	size_t cntReexecutedStates_;
+
 protected:
 
 	/**
@@ -207,6 +222,76 @@ protected:
 		}
 	}
 
+	/**
+	 * @brief  Records that a fixpoint is reached from another one
+	 *
+	 * Walks the path of the given state backwards up to the nearest fixpoint
+	 * and records that the fixpoint of the state depends on it.
+	 *
+	 * @param[in]  state  The state that is about to enter a fixpoint
+	 */
+	void recordFixpointDep(const ExecState& state)
+	{
+		AbstractInstruction* instr = state.GetMem()->GetInstr();
+		assert(fi_type_e::fiFix == instr->getType());
+
+		for (SymState* anc = state.GetMem()->GetParent(); anc;
+			anc = anc->GetParent())
+		{
+			if (anc->GetInstr()->getType() == fi_type_e::fiFix)
+			{	// the nearest fixpoint on the path
+				fixDeps_[anc->GetInstr()].insert(instr);
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief  Handles discovery of a new box without restarting everything
+	 *
+	 * Clears the fixpoint where the new box was discovered together with all
+	 * fixpoints that (transitively) depend on it and executes the state once
+	 * again, now with the new box available.  The other fixpoints and the
+	 * queue of pending states are kept.
+	 *
+	 * @param[in]  state  The state being executed when the box was discovered
+	 */
+	void restartIncrementally(const ExecState& state)
+	{
+		std::vector<AbstractInstruction*> todo(1, state.GetMem()->GetInstr());
+		std::set<AbstractInstruction*> seen(todo.begin(), todo.end());
+
+		while (!todo.empty())
+		{
+			AbstractInstruction* instr = todo.back();
+			todo.pop_back();
+
+			if (instr->getType() != fi_type_e::fiFix)
+			{
+				continue;
+			}
+
+			// clear the fixpoint
+			static_cast<FixpointInstruction*>(instr)->clear();
+			++cntClearedFixpoints_;
+
+			for (auto dep : fixDeps_[instr])
+			{
+				if (seen.insert(dep).second)
+				{
+					todo.push_back(dep);
+				}
+			}
+		}
+
+		FA_DEBUG_AT(2, "incremental restart cleared " << seen.size()
+			<< " fixpoint(s)");
+
+		// the state has not been processed, execute it again
+		execMan_.requeue(state);
+		++cntReexecutedStates_;
+	}
+
 	/**
 	 * @brief  The main execution loop
 	 *
@@ -221,6 +306,9 @@ protected:
 		std::shared_ptr<FAE> fae = std::shared_ptr<FAE>(
 			new FAE(taBackend_, boxMan_));
 
+		// instructions executed in place do not show up in the trace
+		execMan_.setInPlace(!conf_.printTrace && !conf_.printUcodeTrace);
+
 		FA_DEBUG_AT(2, "scheduling initial state ...");
 
 		// schedule the initial state for processing
@@ -231,11 +319,10 @@ protected:
 		);
 
 		ExecState state;
+		size_t cntStates = 0;
 
 		try
 		{	// expecting problems...
-			size_t cntStates = 0;
-
 			while (execMan_.dequeueDFS(state))
 			{	// process all states in the DFS order
 				const CodeStorage::Insn* insn = state.GetMem()->GetInstr()->insn();
@@ -254,9 +341,29 @@ protected:
 					FA_NOTE("Executed " << std::setw(7) << cntStates << " states so far.");
 				}
 
-				// run the state
-				execMan_.execute(state);
-				++cntStates;
+				if (!conf_.incrRestart)
+				{	// run the state
+					execMan_.execute(state);
+					++cntStates;
+					continue;
+				}
+
+				if (state.GetMem()->GetInstr()->getType() == fi_type_e::fiFix)
+				{
+					this->recordFixpointDep(state);
+				}
+
+				try
+				{	// run the state
+					execMan_.execute(state);
+					++cntStates;
+				}
+				catch (RestartRequest& e)
+				{
+					FA_DEBUG_AT(2, e.what());
+					++cntRestarts_;
+					this->restartIncrementally(state);
+				}
 			}
 
 			return true;
@@ -264,7 +371,11 @@ protected:
 		catch (ProgramError& e)
 		{
 			//Engine::printTrace(state);
-			const CodeStorage::Insn* insn = state.GetMem()->GetInstr()->insn();
+			const AbstractInstruction* instr = (nullptr != e.instr())
+				? e.instr()
+				: state.GetMem()->GetInstr();
+
+			const CodeStorage::Insn* insn = instr->insn();
 			if (nullptr != insn) {
 				FA_NOTE_MSG(&insn->loc, SSD_INLINE_COLOR(C_LIGHT_RED, *insn));
 				FA_DEBUG_AT(2, std::endl << *state.GetMem()->GetFAE());
@@ -306,10 +417,15 @@ protected:
 
 				// clear the fixpoint
 				static_cast<FixpointInstruction*>(instr)->clear();
+				++cntClearedFixpoints_;
 			}
 
 			FA_DEBUG_AT(2, e.what());
 
+			// all the states executed so far are going to be executed again
+			++cntRestarts_;
+			cntReexecutedStates_ += cntStates;
+
 			return false;
 		}
 	}
@@ -325,12 +441,17 @@ public:   // methods
 		taBackend_{},
 		fixpointBackend_{},
 		boxMan_{},
+		boxDb_(taBackend_, boxMan_),
 		compiler_(fixpointBackend_, taBackend_, boxMan_),
 		assembly_{},
 		execMan_{},
 		conf_(conf),
 		dbgFlag_{false},
-		userRequestFlag_{false}
+		userRequestFlag_{false},
+		fixDeps_{},
+		cntRestarts_{0},
+		cntClearedFixpoints_{0},
+		cntReexecutedStates_{0}
 	{ }
 
 	/**
@@ -426,23 +547,35 @@ public:   // methods
 			<< *boxMan_.getTypeInfo(GLOBAL_VARS_BLOCK_STR));
 	}
 
-#if 0
-	void loadBoxes(const std::unordered_map<std::string, std::string>& db) {
-
+	/**
+	 * @brief  Loads boxes from a box database
+	 *
+	 * Loads the boxes learned by previous runs from the database @p fileName.
+	 * The types need to be loaded first by the method @p loadTypes.
+	 *
+	 * @param[in]  fileName  Name of the database file
+	 */
+	void loadBoxDb(const std::string& fileName)
+	{
 		FA_DEBUG_AT(2, "loading boxes ...");
 
-		for (auto p : db) {
-
-			this->boxes.push_back((const Box*)boxMan_.loadBox(p.first, db));
-
-			FA_DEBUG(p.first << ':' << std::endl << *(const FA*)this->boxes.back());
-
-		}
+		boxDb_.load(fileName);
+	}
 
-		boxMan_.buildBoxHierarchy(this->hierarchy, this->basicBoxes);
+	/**
+	 * @brief  Saves boxes to a box database
+	 *
+	 * Stores the boxes known to the box manager (including the ones learned
+	 * during this run) into the database @p fileName.
+	 *
+	 * @param[in]  fileName  Name of the database file
+	 */
+	void saveBoxDb(const std::string& fileName)
+	{
+		FA_DEBUG_AT(2, "saving boxes ...");
 
+		boxDb_.save(fileName);
 	}
-#endif
 
 	void compile(const CodeStorage::Storage& stor, const CodeStorage::Fnc& entry)
 	{
@@ -490,6 +623,25 @@ public:   // methods
 			FA_DEBUG_AT(1, "forester has generated " << execMan_.statesEvaluated()
 				<< " symbolic configuration(s) in " << execMan_.pathsEvaluated()
 				<< " path(s) using " << boxMan_.boxDatabase().size() << " box(es)");
+
+			FA_DEBUG_AT(1, "box manager has resolved " << boxMan_.lookupCount()
+				<< " label look-up(s) to " << boxMan_.labelCount() << " label(s)");
+
+			FA_DEBUG_AT(1, "forester has executed " << execMan_.instrsInPlace()
+				<< " instruction(s) in place, without a symbolic configuration");
+
+			FA_DEBUG_AT(1, "peephole pass has dropped " << assembly_.cntPeepholeDropped_
+				<< " instruction(s) and fused " << assembly_.cntPeepholeFused_
+				<< " pair(s) of instructions");
+
+			FA_DEBUG_AT(1, "connection graph has computed "
+				<< ConnectionGraph::cntComputed << " cut-point signature(s) and reused "
+				<< ConnectionGraph::cntReused << " invalidated one(s)");
+
+			FA_DEBUG_AT(1, "forester has restarted " << cntRestarts_
+				<< " time(s), cleared " << cntClearedFixpoints_
+				<< " fixpoint(s) and re-executed " << cntReexecutedStates_
+				<< " state(s) because of new boxes");
 		}
 		catch (const ProgramError& e)
 		{ }
@@ -558,11 +710,21 @@ void SymExec::loadTypes(const CodeStorage::Storage& stor)
 	this->engine->loadTypes(stor);
 }
 
-#if 0
-void SymExec::loadBoxes(const std::unordered_map<std::string, std::string>& db) {
-	this->engine->loadBoxes(db);
+void SymExec::loadBoxDb(const std::string& fileName)
+{
+	// Assertions
+	assert(engine != nullptr);
+
+	this->engine->loadBoxDb(fileName);
+}
+
+void SymExec::saveBoxDb(const std::string& fileName)
+{
+	// Assertions
+	assert(engine != nullptr);
+
+	this->engine->saveBoxDb(fileName);
 }
-#endif
 
 const Compiler::Assembly& SymExec::GetAssembly() const
 {
@@ -77,7 +77,26 @@ public:   // methods
 	 */
 	void loadTypes(const CodeStorage::Storage& stor);
 
-//	void loadBoxes(const std::unordered_map<std::string, std::string>& db);
+	/**
+	 * @brief  Loads boxes from a box database
+	 *
+	 * Loads the boxes learned by previous runs of Forester from the database
+	 * file @p fileName (if it exists).  The types need to be loaded first by the
+	 * method @p loadTypes.
+	 *
+	 * @param[in]  fileName  Name of the database file
+	 */
+	void loadBoxDb(const std::string& fileName);
+
+	/**
+	 * @brief  Saves boxes to a box database
+	 *
+	 * Merges the boxes known after the analysis into the database file @p
+	 * fileName so that they can be reused by subsequent runs.
+	 *
+	 * @param[in]  fileName  Name of the database file
+	 */
+	void saveBoxDb(const std::string& fileName);
 
 
 	/**
@@ -25,6 +25,7 @@
 #include <ostream>
 #include <cassert>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 // Boost headers
@@ -187,6 +188,30 @@ struct Data {
 	 */
 	typedef std::pair<size_t /* offset */, Data> item_info;
 
+	/**
+	 * @brief  Nested data of a structure
+	 *
+	 * The items are shared by all copies of a structure (they are reference
+	 * counted), so that copying of a structure, e.g. together with the register
+	 * file, does not copy the nested data.  The items must therefore not be
+	 * modified once the structure has been copied or hashed, i.e. only right
+	 * after it has been created by createStruct().
+	 */
+	struct StructItems : public std::vector<item_info> {
+
+		/// the number of Data objects sharing the items
+		size_t refCnt;
+
+		/// the hash of the items, zero if not computed yet
+		mutable size_t hash;
+
+		StructItems(const std::vector<item_info>& items) :
+			std::vector<item_info>(items),
+			refCnt(1),
+			hash(0)
+		{ }
+	};
+
 	/// The type of the data
 	data_type_e type;
 
@@ -206,7 +231,7 @@ struct Data {
 
 		int		d_int;                        ///< value of represented integer
 		bool	d_bool;                       ///< value of represented Boolean
-		std::vector<item_info>* d_struct;   ///< nested data types for structure
+		StructItems* d_struct;              ///< nested data types for structure
 	};
 
 	/**
@@ -226,22 +251,23 @@ struct Data {
 	 * @param[in]  data  The object to be copied
 	 */
 	Data(const Data& data) : type(data.type), size(data.size) {
-		// fill the additional type information according to the type of data
-		switch (data.type) {
-			case data_type_e::t_native_ptr:
-				this->d_native_ptr = data.d_native_ptr; break;
-			case data_type_e::t_void_ptr:
-				this->d_void_ptr_size = data.d_void_ptr_size; break;
-			case data_type_e::t_ref:
-				this->d_ref.root = data.d_ref.root;
-				this->d_ref.displ = data.d_ref.displ; break;
-			case data_type_e::t_int:
-				this->d_int = data.d_int; break;
-			case data_type_e::t_bool:
-				this->d_bool = data.d_bool; break;
-			case data_type_e::t_struct:
-				this->d_struct = new std::vector<item_info>(*data.d_struct); break;
-			default: break;
+		this->copyValue(data);
+	}
+
+	/**
+	 * @brief  Move constructor
+	 *
+	 * Moving constructor, takes over the nested data of a structure.
+	 *
+	 * @param[in]  data  The object to be moved
+	 */
+	Data(Data&& data) : type(data.type), size(data.size) {
+		this->copyValue(data);
+
+		if (data_type_e::t_struct == data.type)
+		{	// the items now belong to this object
+			--this->d_struct->refCnt;
+			data.type = data_type_e::t_undef;
 		}
 	}
 
@@ -264,27 +290,39 @@ struct Data {
 	Data& operator=(const Data& rhs) {
 		if (this == &rhs) { return *this; }
 
-		this->clear();
+		// the items of a structure may be shared with rhs, release them after
+		// the new value is in place
+		Data old(std::move(*this));
+
 		this->type = rhs.type;
 		this->size = rhs.size;
+		this->copyValue(rhs);
 
-		// fill the additional type information according to the type of data
-		/// @todo: remove duplicit code
-		switch (rhs.type) {
-			case data_type_e::t_native_ptr:
-				this->d_native_ptr = rhs.d_native_ptr; break;
-			case data_type_e::t_void_ptr:
-				this->d_void_ptr_size = rhs.d_void_ptr_size; break;
-			case data_type_e::t_ref:
-				this->d_ref.root = rhs.d_ref.root;
-				this->d_ref.displ = rhs.d_ref.displ; break;
-			case data_type_e::t_int:
-				this->d_int = rhs.d_int; break;
-			case data_type_e::t_bool:
-				this->d_bool = rhs.d_bool; break;
-			case data_type_e::t_struct:
-				this->d_struct = new std::vector<item_info>(*rhs.d_struct); break;
-			default: break;
+		return *this;
+	}
+
+	/**
+	 * @brief  The move assignment operator
+	 *
+	 * The move assignment operator, takes over the nested data of a structure.
+	 *
+	 * @param[in]  rhs  The object to be moved
+	 *
+	 * @returns  The object
+	 */
+	Data& operator=(Data&& rhs) {
+		if (this == &rhs) { return *this; }
+
+		Data old(std::move(*this));
+
+		this->type = rhs.type;
+		this->size = rhs.size;
+		this->copyValue(rhs);
+
+		if (data_type_e::t_struct == rhs.type)
+		{	// the items now belong to this object
+			--this->d_struct->refCnt;
+			rhs.type = data_type_e::t_undef;
 		}
 
 		return *this;
@@ -352,7 +390,7 @@ struct Data {
 	static Data createStruct(
 		const std::vector<item_info>& items = std::vector<item_info>()) {
 		Data data(data_type_e::t_struct);
-		data.d_struct = new std::vector<item_info>(items);
+		data.d_struct = new StructItems(items);
 		return data;
 	}
 
@@ -455,12 +493,44 @@ struct Data {
 	 * Clears the structure.
 	 */
 	void clear() {
-		if (this->type == data_type_e::t_struct) {
+		if ((this->type == data_type_e::t_struct) && !--this->d_struct->refCnt) {
 			delete this->d_struct;
 		}
 		this->type = data_type_e::t_undef;
 	}
 
+private:
+
+	/**
+	 * @brief  Copies the value of another object of the same type
+	 *
+	 * Fills the additional type information according to the type of @p data,
+	 * the nested data of a structure are shared.
+	 *
+	 * @param[in]  data  The object the value of which is copied
+	 */
+	void copyValue(const Data& data) {
+		switch (data.type) {
+			case data_type_e::t_native_ptr:
+				this->d_native_ptr = data.d_native_ptr; break;
+			case data_type_e::t_void_ptr:
+				this->d_void_ptr_size = data.d_void_ptr_size; break;
+			case data_type_e::t_ref:
+				this->d_ref.root = data.d_ref.root;
+				this->d_ref.displ = data.d_ref.displ; break;
+			case data_type_e::t_int:
+				this->d_int = data.d_int; break;
+			case data_type_e::t_bool:
+				this->d_bool = data.d_bool; break;
+			case data_type_e::t_struct:
+				this->d_struct = data.d_struct;
+				++this->d_struct->refCnt; break;
+			default: break;
+		}
+	}
+
+public:
+
 	/**
 	 * @brief  Are the type and value defined?
 	 *
@@ -623,7 +693,12 @@ struct Data {
 				boost::hash_combine(seed, v.d_bool);
 				break;
 			case data_type_e::t_struct:
-				boost::hash_combine(seed, *v.d_struct);
+				if (!v.d_struct->hash)
+				{	// the items are shared and not modified, compute the hash once
+					v.d_struct->hash = boost::hash_value(
+						static_cast<const std::vector<item_info>&>(*v.d_struct)) | 1;
+				}
+				boost::hash_combine(seed, v.d_struct->hash);
 				break;
 			case data_type_e::t_other:
 				boost::hash_combine(seed, v.d_void_ptr_size);
@@ -667,7 +742,9 @@ struct Data {
 			case data_type_e::t_bool:
 				return this->d_bool == rhs.d_bool;
 			case data_type_e::t_struct:
-				return *this->d_struct == *rhs.d_struct;
+				return (this->d_struct == rhs.d_struct) ||
+					(static_cast<const std::vector<item_info>&>(*this->d_struct) ==
+					 static_cast<const std::vector<item_info>&>(*rhs.d_struct));
 			default:
 				return false;
 		}
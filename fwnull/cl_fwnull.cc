@@ -24,15 +24,59 @@
 #include <cl/clutil.hh>
 #include <cl/storage.hh>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <map>
 #include <queue>
 #include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/foreach.hpp>
 
 // required by the gcc plug-in API
 extern "C" { int plugin_is_GPL_compatible; }
 
+/// a message emitted while analyzing a function, printed once all are done
+struct Msg {
+    void (*emit)(const char *);
+    std::string         text;
+};
+
+typedef std::vector<Msg>                                TMsgList;
+
+/// messages of the function being analyzed by the current thread
+static __thread TMsgList *msgList;
+
+/// same as CL_MSG_STREAM, but the message goes to msgList
+#define FN_MSG_STREAM(fnc, to_stream) do {              \
+    if ((cl_debug == (fnc)) && !cl_debug_level())       \
+        break;                                          \
+                                                        \
+    std::ostringstream str;                             \
+    str << to_stream;                                   \
+    const Msg msg = { (fnc), str.str() };               \
+    msgList->push_back(msg);                            \
+} while (0)
+
+#define FN_DEBUG_MSG(loc, what) \
+    FN_MSG_STREAM(cl_debug, *(loc) << "debug: " << what)
+
+#define FN_WARN_MSG(loc, what) \
+    FN_MSG_STREAM(cl_warn, *(loc) << "warning: " << what)
+
+#define FN_ERROR_MSG(loc, what) \
+    FN_MSG_STREAM(cl_error, *(loc) << "error: " << what)
+
+#define FN_NOTE_MSG(loc, what) \
+    FN_MSG_STREAM(cl_note, *(loc) << "note: " << what)
+
 /// variable state enumeration
 enum EVarState {
     VS_UNDEF,                   ///< value not assigned yet
@@ -65,17 +109,133 @@ struct VarState {
     }
 };
 
+/// dense numbering of the variables used in a function
+class VarIndex {
+    public:
+        VarIndex():
+            base_(0)
+        {
+        }
+
+        /// register a variable, to be called before seal()
+        void add(const int uid) {
+            uids_.push_back(uid);
+        }
+
+        /// number the variables, no add() is allowed afterwards
+        void seal() {
+            std::sort(uids_.begin(), uids_.end());
+            uids_.erase(std::unique(uids_.begin(), uids_.end()), uids_.end());
+            if (uids_.empty())
+                return;
+
+            // the uids of a function are mostly clustered, so a direct-indexed
+            // table is usually affordable; the hash map is only a fallback
+            base_ = uids_.front();
+            const size_t range = uids_.back() - base_ + 1;
+            const bool useTable = (range <= 8U * uids_.size() + 1024U);
+            if (useTable)
+                table_.resize(range, 0U);
+
+            for (unsigned i = 0; i < uids_.size(); ++i) {
+                if (useTable)
+                    table_[uids_[i] - base_] = i + 1U;
+                else
+                    map_[uids_[i]] = i;
+            }
+        }
+
+        size_t size() const {
+            return uids_.size();
+        }
+
+        /// dense index of the given variable, computed by seal() already
+        unsigned of(const int uid) const {
+            if (!table_.empty()) {
+                const unsigned rel = uid - base_;
+                CL_BREAK_IF(table_.size() <= rel);
+
+                const unsigned slot = table_[rel];
+                CL_BREAK_IF(!slot);
+                return slot - 1U;
+            }
+
+            const TMap::const_iterator it = map_.find(uid);
+            CL_BREAK_IF(map_.end() == it);
+            return it->second;
+        }
+
+    private:
+        typedef std::unordered_map<int /* uid */, unsigned /* idx */> TMap;
+
+        std::vector<int>        uids_;
+        int                     base_;
+        std::vector<unsigned>   table_;     ///< idx + 1 by (uid - base_)
+        TMap                    map_;
+};
+
+/// state of all variables of a function, indexed by VarIndex
+struct VarStateVec {
+    const VarIndex         *idx;
+    std::vector<VarState>   vars;
+
+    VarStateVec():
+        idx(0)
+    {
+    }
+
+    explicit VarStateVec(const VarIndex &idx_):
+        idx(&idx_),
+        vars(idx_.size())
+    {
+    }
+
+    VarState& operator[](const int uid) {
+        return vars[idx->of(uid)];
+    }
+
+    const VarState& operator[](const int uid) const {
+        return vars[idx->of(uid)];
+    }
+};
+
+/// only the variables not in VS_UNDEF, sorted by their index in VarIndex
+typedef std::vector<std::pair<unsigned /* idx */, VarState> >  TPackedState;
+
+/// expand a state stored by packState() to all variables of the function
+void unpackState(VarStateVec &dst, const TPackedState &src)
+{
+    std::fill(dst.vars.begin(), dst.vars.end(), VarState());
+    for (unsigned i = 0; i < src.size(); ++i)
+        dst.vars[src[i].first] = src[i].second;
+}
+
+/// keep only the variables that are not in VS_UNDEF
+void packState(TPackedState &dst, const VarStateVec &src)
+{
+    dst.clear();
+    for (unsigned i = 0; i < src.vars.size(); ++i)
+        if (VS_UNDEF != src.vars[i].code)
+            dst.push_back(std::make_pair(i, src.vars[i]));
+}
+
 /// state of computation at function level
 struct Data {
     typedef const CodeStorage::Block                   *TBlock;
-    typedef std::queue<TBlock>                          TSched;
-    typedef std::set<TBlock>                            TSchedLookup;
-    typedef std::map<int /* var uid */, VarState>       TState;
-    typedef std::map<TBlock, TState>                    TStateMap;
-
-    TSched          todo;       ///< block scheduled for processing
-    TSchedLookup    todoLookup; ///< block scheduled for processing
-    TStateMap       stateMap;   ///< holds states of all vars per each block
+    typedef VarStateVec                                 TState;
+
+    /// blocks scheduled for processing, by their index in reverse post-order
+    typedef std::priority_queue<unsigned, std::vector<unsigned>,
+            std::greater<unsigned> >                    TSched;
+
+    VarIndex                    varIdx;     ///< numbering of variables
+    std::vector<TBlock>         rpo;        ///< blocks in reverse post-order
+    std::map<TBlock, unsigned>  rpoIdx;     ///< index of a block in rpo
+    std::vector<TPackedState>   states;     ///< states of vars per each block
+    TState                      current;    ///< state of the block processed
+    TState                      merged;     ///< scratch state of updateState()
+    TSched                      todo;       ///< blocks scheduled for processing
+    std::vector<bool>           todoLookup; ///< blocks scheduled for processing
 };
 
 /**
@@ -103,17 +263,18 @@ void handleVarDeref(Data::TState                        &state,
             return;
 
         case VS_NULL:
-            CL_ERROR_MSG(lw, "dereference of NULL value");
-            CL_NOTE_MSG(vs.lw, "the NULL value comes from here");
+            FN_ERROR_MSG(lw, "dereference of NULL value");
+            FN_NOTE_MSG(vs.lw, "the NULL value comes from here");
             return;
 
         case VS_NULL_DEDUCED:
-            CL_ERROR_MSG(lw, "dereference of NULL value");
-            CL_NOTE_MSG(vs.lw, "the condition seems to be used incorrectly");
+            FN_ERROR_MSG(lw, "dereference of NULL value");
+            FN_NOTE_MSG(vs.lw, "the condition seems to be used incorrectly");
+            return;
 
         case VS_MIGHT_BE_NULL:
-            CL_WARN_MSG(lw, "dereference of a value that might be NULL");
-            CL_NOTE_MSG(vs.lw, "the same value was compared with NULL here");
+            FN_WARN_MSG(lw, "dereference of a value that might be NULL");
+            FN_NOTE_MSG(vs.lw, "the same value was compared with NULL here");
             return;
 
         default:
@@ -296,8 +457,8 @@ bool handleInsnCmpNull(Data::TState                 &state,
             break;
 
         case VS_DEREF:
-            CL_WARN_MSG(lw, "comparing pointer with NULL");
-            CL_NOTE_MSG(vsSrc.lw, "the pointer was already dereferenced here");
+            FN_WARN_MSG(lw, "comparing pointer with NULL");
+            FN_NOTE_MSG(vsSrc.lw, "the pointer was already dereferenced here");
             break;
 
         default:
@@ -481,18 +642,27 @@ void updateState(Data                           &data,
                  const CodeStorage::Block       *block)
 {
     // target state
-    typedef Data::TState TState;
-    TState &dstState = data.stateMap[block];
+    const unsigned idx = data.rpoIdx[block];
+    Data::TState &dst = data.merged;
+    unpackState(dst, data.states[idx]);
+    std::vector<VarState> &dstVars = dst.vars;
+    const std::vector<VarState> &srcVars = state.vars;
 
     // for each variable
     bool changed = false;
-    BOOST_FOREACH(TState::const_reference item, state) {
-        if (mergeValues(dstState[item.first], item.second))
+    for (unsigned i = 0; i < srcVars.size(); ++i) {
+        if (mergeValues(dstVars[i], srcVars[i]))
             changed = true;
     }
 
-    if (changed && data.todoLookup.insert(block)./* not already in */second)
-        data.todo.push(block);
+    if (!changed)
+        return;
+
+    packState(data.states[idx], dst);
+    if (!data.todoLookup[idx]) {
+        data.todoLookup[idx] = true;
+        data.todo.push(idx);
+    }
 }
 
 /**
@@ -545,22 +715,32 @@ void replaceInBranch(Data::TState &state, int uid, bool val)
  * @param targets then/else targets of the condition
  */
 void handleInsnCondNondet(Data                              &data,
-                          const Data::TState                &state,
+                          Data::TState                      &state,
                           const struct cl_operand           &cond,
                           const CodeStorage::TTargetList    &targets)
 {
-    // local copies of the state
-    Data::TState stateThen(state);
-    Data::TState stateElse(state);
-
-    // reflect the value of branch-by variable (if possible)
-    int uid = varIdFromOperand(&cond);
-    replaceInBranch(stateThen, uid, true);
-    replaceInBranch(stateElse, uid, false);
-
-    // go to both targets and update the state there
-    updateState(data, stateThen, targets[0]);
-    updateState(data, stateElse, targets[1]);
+    // the branches differ in the branch-by variable and its peer only, so we
+    // update the state in place and roll it back instead of copying it
+    const int uid = varIdFromOperand(&cond);
+    const VarState vsOrig = state[uid];
+    const bool hasPeer = (VS_NULL_IFF == vsOrig.code)
+        || (VS_NOT_NULL_IFF == vsOrig.code);
+    const VarState vsPeerOrig = (hasPeer)
+        ? state[vsOrig.peer]
+        : VarState();
+
+    for (unsigned i = 0; i < 2; ++i) {
+        // reflect the value of branch-by variable (if possible)
+        const bool val = !i;
+        replaceInBranch(state, uid, val);
+
+        // go to the target and update the state there
+        updateState(data, state, targets[i]);
+
+        state[uid] = vsOrig;
+        if (hasPeer)
+            state[vsOrig.peer] = vsPeerOrig;
+    }
 }
 
 /**
@@ -569,15 +749,13 @@ void handleInsnCondNondet(Data                              &data,
  * @param insn conditional instruction you want to process
  */
 void handleInsnCond(Data                                    &data,
-                    const Data::TState                      &state,
+                    Data::TState                            &state,
                     const CodeStorage::Insn                 *insn)
 {
     // resolve branch-by operand
     const struct cl_operand &cond = insn->operands[0];
     const int uid = varIdFromOperand(&cond);
-    Data::TState::const_iterator it = state.find(uid);
-    CL_BREAK_IF(state.end() == it);
-    const VarState &vs = it->second;
+    const VarState &vs = state[uid];
 
     // now check if we know the value
     const EVarState code = vs.code;
@@ -603,7 +781,7 @@ void handleInsnCond(Data                                    &data,
  * @param insn instruction you want to process
  */
 void handleInsnTerm(Data                            &data,
-                    const Data::TState              &state,
+                    Data::TState                    &state,
                     const CodeStorage::Insn         *insn)
 {
     const enum cl_insn_e code = insn->code;
@@ -627,10 +805,12 @@ void handleInsnTerm(Data                            &data,
     }
 }
 
-void handleBlock(Data &data, Data::TBlock bb)
+void handleBlock(Data &data, const unsigned idx)
 {
     // go through the sequence of instructions of the current basic block
-    Data::TState next = data.stateMap[bb];
+    const Data::TBlock bb = data.rpo[idx];
+    Data::TState &next = data.current;
+    unpackState(next, data.states[idx]);
     BOOST_FOREACH(const CodeStorage::Insn *insn, *bb) {
         if (cl_is_term_insn(insn->code))
             // terminal instruction
@@ -642,46 +822,161 @@ void handleBlock(Data &data, Data::TBlock bb)
     }
 }
 
+/// number the variables and put the blocks reachable from entry in RPO
+void initData(Data &data, const CodeStorage::Fnc &fnc)
+{
+    using namespace CodeStorage;
+
+    // post-order DFS through the CFG
+    typedef std::pair<Data::TBlock, unsigned /* next target */> TDfsItem;
+    std::vector<TDfsItem> dfsStack;
+    std::set<Data::TBlock> seen;
+
+    const Data::TBlock entry = fnc.cfg.entry();
+    dfsStack.push_back(TDfsItem(entry, 0U));
+    seen.insert(entry);
+    while (!dfsStack.empty()) {
+        TDfsItem &item = dfsStack.back();
+        const TTargetList &targets = item.first->targets();
+        if (item.second < targets.size()) {
+            const Data::TBlock dst = targets[item.second++];
+            if (seen.insert(dst)./* not yet seen */second)
+                dfsStack.push_back(TDfsItem(dst, 0U));
+
+            continue;
+        }
+
+        data.rpo.push_back(item.first);
+        dfsStack.pop_back();
+    }
+
+    std::reverse(data.rpo.begin(), data.rpo.end());
+    for (unsigned i = 0; i < data.rpo.size(); ++i) {
+        const Data::TBlock bb = data.rpo[i];
+        data.rpoIdx[bb] = i;
+
+        // register all variables used in the block
+        BOOST_FOREACH(const Insn *insn, *bb)
+            BOOST_FOREACH(const struct cl_operand &op, insn->operands)
+                if (CL_OPERAND_VAR == op.code)
+                    data.varIdx.add(varIdFromOperand(&op));
+    }
+
+    data.varIdx.seal();
+    data.states.resize(data.rpo.size());
+    data.current = Data::TState(data.varIdx);
+    data.merged = Data::TState(data.varIdx);
+    data.todoLookup.resize(data.rpo.size(), false);
+}
+
 void handleFnc(const CodeStorage::Fnc &fnc)
 {
     using namespace CodeStorage;
 
     Data data;
-    Data::TSched &todo = data.todo;
-    const ControlFlow &cfg = fnc.cfg;
+    initData(data, fnc);
 
-    // block-level scheduler
-    Data::TBlock bb = cfg.entry();
-    todo.push(bb);
-    data.todoLookup.insert(bb);
+    // block-level scheduler, the entry block comes first in RPO
+    Data::TSched &todo = data.todo;
+    todo.push(/* entry */ 0U);
+    data.todoLookup[0] = true;
     while (!todo.empty()) {
-        Data::TBlock bb = todo.front();
+        const unsigned idx = todo.top();
         todo.pop();
-        if (1 != data.todoLookup.erase(bb))
-            CL_BREAK_IF("BlockScheduler malfunction");
+        CL_BREAK_IF(!data.todoLookup[idx]);
+        data.todoLookup[idx] = false;
 
         // process one basic block
+        const Data::TBlock bb = data.rpo[idx];
         CL_BREAK_IF(!bb || !bb->size());
         const Insn *insn = bb->operator[](0);
-        CL_DEBUG_MSG(&insn->loc, "analyzing block " << bb->name() << "...");
-        handleBlock(data, bb);
+        FN_DEBUG_MSG(&insn->loc, "analyzing block " << bb->name() << "...");
+        handleBlock(data, idx);
     }
 }
 
-// /////////////////////////////////////////////////////////////////////////////
-// see easy.hh for details
-void clEasyRun(const CodeStorage::Storage &stor, const char *)
+typedef std::vector<const CodeStorage::Fnc *>           TFncList;
+
+/// take functions from fncs until there is none left, may run in parallel
+void analyzeFncs(
+        const TFncList                  &fncs,
+        std::vector<TMsgList>           &msgs,
+        std::atomic<size_t>             &next)
 {
     using namespace CodeStorage;
 
-    BOOST_FOREACH(const Fnc *pFnc, stor.fncs) {
-        const Fnc &fnc = *pFnc;
-        if (!isDefined(fnc))
-            continue;
+    for (;;) {
+        const size_t idx = next++;
+        if (fncs.size() <= idx)
+            return;
 
-        CL_DEBUG_MSG(&fnc.def.data.cst.data.cst_fnc.loc, "analyzing function "
+        // the functions are independent of each other, only the messages
+        // need to be collected per function
+        msgList = &msgs[idx];
+        const Fnc &fnc = *fncs[idx];
+
+        FN_DEBUG_MSG(&fnc.def.data.cst.data.cst_fnc.loc, "analyzing function "
                 << nameOf(fnc) << "()...");
 
         handleFnc(fnc);
     }
 }
+
+/// read the count of threads from the "jobs:N" config string
+unsigned jobsFromConfig(const char *configString)
+{
+    static const char prefix[] = "jobs:";
+    static const size_t prefixLen = sizeof(prefix) - 1U;
+
+    if (configString && !strncmp(configString, prefix, prefixLen)) {
+        const int jobs = atoi(configString + prefixLen);
+        if (0 < jobs)
+            return jobs;
+
+        CL_WARN("ignoring invalid config string: " << configString);
+    }
+
+#if FWNULL_MAX_JOBS
+    return FWNULL_MAX_JOBS;
+#else
+    // use all available CPUs
+    const unsigned cpus = std::thread::hardware_concurrency();
+    return (cpus) ? cpus : 1U;
+#endif
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// see easy.hh for details
+void clEasyRun(const CodeStorage::Storage &stor, const char *configString)
+{
+    using namespace CodeStorage;
+
+    TFncList fncs;
+    BOOST_FOREACH(const Fnc *pFnc, stor.fncs) {
+        if (isDefined(*pFnc))
+            fncs.push_back(pFnc);
+    }
+
+    // the storage is only read from now on, so the functions can be analyzed
+    // concurrently; the main thread participates as one of the workers
+    std::vector<TMsgList> msgs(fncs.size());
+    std::atomic<size_t> next(0U);
+
+    unsigned jobs = jobsFromConfig(configString);
+    if (fncs.size() < jobs)
+        jobs = fncs.size();
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1U; i < jobs; ++i)
+        workers.push_back(std::thread(analyzeFncs,
+                    std::cref(fncs), std::ref(msgs), std::ref(next)));
+
+    analyzeFncs(fncs, msgs, next);
+    BOOST_FOREACH(std::thread &worker, workers)
+        worker.join();
+
+    // print the messages in the order of functions, as if analyzed in a row
+    BOOST_FOREACH(const TMsgList &ml, msgs)
+        BOOST_FOREACH(const Msg &msg, ml)
+            msg.emit(msg.text.c_str());
+}
@@ -24,3 +24,9 @@
 
 #define GIT_SHA1 fwnull_git_sha1
 #include "trap.h"
+
+/**
+ * count of threads used to analyze functions in parallel, zero means to use
+ * all the available CPUs (can be overridden by the "jobs:N" config string)
+ */
+#define FWNULL_MAX_JOBS 0
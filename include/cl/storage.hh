@@ -154,6 +154,11 @@ class VarDb {
          */
         const Var& operator[](int uid) const;
 
+        /**
+         * return true if a variable with the given ID exists (never crashes)
+         */
+        bool has(int uid) const;
+
         /**
          * return STL-like iterator to go through the container
          */
@@ -215,6 +220,11 @@ class TypeDb {
          */
         const struct cl_type* operator[](int) const;
 
+        /**
+         * return true if a type with the given ID exists (never crashes)
+         */
+        bool has(int uid) const;
+
         /**
          * return STL-like iterator to go through the container
          */
@@ -456,7 +466,8 @@ class Block {
          * on a NULL pointer dereference.
          */
         Block():
-            cfg_(0)
+            cfg_(0),
+            retainState_(false)
         {
         }
 
@@ -468,7 +479,8 @@ class Block {
          */
         Block(ControlFlow *cfg, const char *name):
             cfg_(cfg),
-            name_(name)
+            name_(name),
+            retainState_(false)
         {
         }
 
@@ -542,11 +554,22 @@ class Block {
         /// return true, if a loop at the level of CFG starts with this block
         bool isLoopEntry() const;
 
+        /**
+         * return true if the analysis needs to keep the state at the entry of
+         * this block, i.e. the block starts a loop or heaps coming along more
+         * than one path meet there (see findRetainedStates() in loopscan.hh)
+         */
+        bool isStateRetained()               const { return retainState_;   }
+
+        /// used by findRetainedStates() only
+        void setStateRetained()                    { retainState_ = true;   }
+
     private:
         TList insns_;
         TTargetList inbound_;
         ControlFlow *cfg_;
         std::string name_;
+        bool retainState_;
 };
 
 /**
@@ -691,6 +714,11 @@ class FncDb {
          */
         const Fnc* operator[](int uid) const;
 
+        /**
+         * return true if a function with the given ID exists (never crashes)
+         */
+        bool has(int uid) const;
+
         /**
          * return STL-like iterator to go through all functions inside
          */
@@ -730,8 +758,12 @@ namespace CallGraph {
         /// insns that take address of this function, zero key means initializer
         TInsnListByFnc              callbacks;
 
+        /// true if the function can (directly or indirectly) call itself
+        bool                        recursive;
+
         Node(Fnc *fnc_):
-            fnc(fnc_)
+            fnc(fnc_),
+            recursive(false)
         {
         }
     };
@@ -764,6 +796,9 @@ struct Storage {
     NameDb                      varNames;   ///< var names lookup container
     NameDb                      fncNames;   ///< fnc names lookup container
     CallGraph::Graph            callGraph;  ///< call graph globals
+
+    /// integral constants of the program and their neighbours, sorted
+    STD_VECTOR(long)            intThresholds;
 };
 
 } // namespace CodeStorage
@@ -18,7 +18,8 @@
  *
  * - garbage collector: collectJunk(), destroyRootAndCollectJunk(), LeakMonitor
  *
- * - generic join algorithm: joinSymHeaps(), joinDataReadOnly(), joinData()
+ * - generic join algorithm: joinSymHeaps(), checkEntailment(),
+ *   joinDataReadOnly(), joinData()
  *
  * - list segment discovery: discoverBestAbstraction()
  *
@@ -25,14 +25,18 @@
 #include <cl/storage.hh>
 
 #include "memdebug.hh"
+#include "profiler.hh"
 #include "symbt.hh"
+#include "symcapture.hh"
 #include "symdump.hh"
 #include "symexec.hh"
+#include "symplot.hh"
 #include "symproc.hh"
 #include "symstate.hh"
 #include "symtrace.hh"
 #include "util.hh"
 
+#include <cstdlib>
 #include <string>
 
 #include <boost/foreach.hpp>
@@ -40,8 +44,14 @@
 // required by the gcc plug-in API
 extern "C" { int plugin_is_GPL_compatible; }
 
+/// if not empty, replay the operations captured in this file (no analysis)
+static std::string replayFile;
+
+/// how many times each of the captured operations is replayed
+static unsigned replayRounds = 10U;
+
 // FIXME: the implementation is amusing
-void parseConfigString(SymExecParams &sep, std::string cnf)
+void parseConfigItem(SymExecParams &sep, std::string cnf)
 {
     using std::string;
     if (cnf.empty())
@@ -65,8 +75,6 @@ void parseConfigString(SymExecParams &sep, std::string cnf)
         return;
     }
 
-    // TODO: make it possible to handle both parameters together (comma
-    // separated list or whatever)
     // TODO: document all the parameters somewhere
     if (string("noplot") == cnf) {
         CL_DEBUG("parseConfigString: \"noplot\" mode requested");
@@ -80,7 +88,100 @@ void parseConfigString(SymExecParams &sep, std::string cnf)
         return;
     }
 
+    if (string("summaries") == cnf) {
+        CL_DEBUG("parseConfigString: \"summaries\" mode requested");
+        sep.fncSummaries = true;
+        return;
+    }
+
+    if (string("profile") == cnf) {
+        CL_DEBUG("parseConfigString: \"profile\" mode requested");
+        Profiler::enable(/* no folded stacks */ string());
+        return;
+    }
+
     const char *cstr = cnf.c_str();
+    const char *profPrefix = "profile:";
+    const size_t profPrefixLen = strlen(profPrefix);
+    if (!strncmp(cstr, profPrefix, profPrefixLen)) {
+        cstr += profPrefixLen;
+        CL_DEBUG("parseConfigString: folded stacks go to \"" << cstr << "\"");
+        Profiler::enable(cstr);
+        return;
+    }
+
+    const char *capPrefix = "capture:";
+    const size_t capPrefixLen = strlen(capPrefix);
+    if (!strncmp(cstr, capPrefix, capPrefixLen)) {
+        cstr += capPrefixLen;
+        CL_DEBUG("parseConfigString: captured heaps go to \"" << cstr << "\"");
+        HeapCapture::enable(cstr);
+        return;
+    }
+
+    const char *repPrefix = "replay:";
+    const size_t repPrefixLen = strlen(repPrefix);
+    if (!strncmp(cstr, repPrefix, repPrefixLen)) {
+        cstr += repPrefixLen;
+        CL_DEBUG("parseConfigString: replaying heaps from \"" << cstr << "\"");
+        replayFile = cstr;
+        return;
+    }
+
+    const char *rrPrefix = "replay_rounds:";
+    const size_t rrPrefixLen = strlen(rrPrefix);
+    if (!strncmp(cstr, rrPrefix, rrPrefixLen)) {
+        cstr += rrPrefixLen;
+        replayRounds = strtoul(cstr, 0, 10);
+        CL_DEBUG("parseConfigString: replay rounds set to " << replayRounds);
+        return;
+    }
+
+    const char *mbPrefix = "mem_budget:";
+    const size_t mbPrefixLen = strlen(mbPrefix);
+    if (!strncmp(cstr, mbPrefix, mbPrefixLen)) {
+        cstr += mbPrefixLen;
+        const size_t mib = strtoul(cstr, 0, 10);
+        CL_DEBUG("parseConfigString: memory budget is " << mib << " MB");
+        sep.memBudget = mib << /* MiB */ 20;
+        return;
+    }
+
+    const char *ccbPrefix = "call_cache_budget:";
+    const size_t ccbPrefixLen = strlen(ccbPrefix);
+    if (!strncmp(cstr, ccbPrefix, ccbPrefixLen)) {
+        cstr += ccbPrefixLen;
+        const size_t mib = strtoul(cstr, 0, 10);
+        CL_DEBUG("parseConfigString: call cache budget is " << mib << " MB");
+        sep.callCacheBudget = mib << /* MiB */ 20;
+        return;
+    }
+
+    const char *sbPrefix = "spill_budget:";
+    const size_t sbPrefixLen = strlen(sbPrefix);
+    if (!strncmp(cstr, sbPrefix, sbPrefixLen)) {
+        cstr += sbPrefixLen;
+        char *unit;
+        const size_t num = strtoul(cstr, &unit, 10);
+
+        // the budget is given in MB, or in KB with the 'K' suffix (for tests)
+        const bool kib = ('K' == *unit);
+        CL_DEBUG("parseConfigString: state spill budget is " << num
+                << ((kib) ? " KB" : " MB"));
+        sep.spillBudget = num << ((kib) ? /* KiB */ 10 : /* MiB */ 20);
+        return;
+    }
+
+    const char *plPrefix = "plot_limit:";
+    const size_t plPrefixLen = strlen(plPrefix);
+    if (!strncmp(cstr, plPrefix, plPrefixLen)) {
+        cstr += plPrefixLen;
+        const unsigned limit = strtoul(cstr, 0, 10);
+        CL_DEBUG("parseConfigString: plot limit is " << limit);
+        setPlotLimit(limit);
+        return;
+    }
+
     const char *elPrefix = "error_label:";
     const size_t elPrefixLen = strlen(elPrefix);
     if (!strncmp(cstr, elPrefix, elPrefixLen)) {
@@ -93,6 +194,22 @@ void parseConfigString(SymExecParams &sep, std::string cnf)
     CL_WARN("unhandled config string: \"" << cnf << "\"");
 }
 
+/// the config string is a comma-separated list of items
+void parseConfigString(SymExecParams &sep, const std::string &cnf)
+{
+    size_t pos = 0U;
+    for (;;) {
+        const size_t end = cnf.find(',', pos);
+        if (std::string::npos == end)
+            break;
+
+        parseConfigItem(sep, cnf.substr(pos, end - pos));
+        pos = end + 1U;
+    }
+
+    parseConfigItem(sep, cnf.substr(pos));
+}
+
 void digGlJunk(SymHeap &sh)
 {
     using namespace CodeStorage;
@@ -204,9 +321,19 @@ void clEasyRun(const CodeStorage::Storage &stor, const char *configString)
     SymExecParams ep;
     parseConfigString(ep, configString);
 
+    if (!replayFile.empty()) {
+        // benchmark the captured operations instead of running the analysis
+        replayCapturedOps(stor, replayFile, replayRounds);
+        Profiler::dump();
+        return;
+    }
+
     // run symbolic execution
     launchSymExec(stor, ep);
 
+    // write the captured heaps (if any)
+    HeapCapture::flush();
+
     if (Trace::Globals::alive()) {
         // plot all pending trace graphs
         Trace::GraphProxy *glProxy = Trace::Globals::instance()->glProxy();
@@ -218,4 +345,6 @@ void clEasyRun(const CodeStorage::Storage &stor, const char *configString)
     }
 
     printPeakMemUsage();
+    printMemAccounting();
+    Profiler::dump();
 }
@@ -102,6 +102,7 @@
 /**
  * bit mask of allowed operations on integral ranges
  * - 0x1 ... allow to create integral ranges from integral constants if needed
+ *           (widening at loop-closing edges creates them regardless of 0x1)
  * - 0x2 ... allow widening of the upper bound of integral ranges
  * - 0x4 ... allow widening of the lower bound of integral ranges
  */
@@ -252,22 +253,23 @@
 #define SE_STATE_ON_THE_FLY_ORDERING        1
 
 /**
- * - 0 ... keep state info for all basic blocks of a function
- * - 1 ... keep state info for all basic blocks except trivial basic blocks
- * - 2 ... keep state info for all basic blocks with more than one ingoing edge
- * - 3 ... keep state info for all basic blocks that a CFG loop starts with
+ * prune retained non-loop blocks on reaching the count of join misses (0 means
+ * disabled), other non-loop blocks are pruned as soon as they are processed
  */
-#define SE_STATE_PRUNING_MODE               1
+#define SE_STATE_PRUNING_MISS_THR           0x20
 
 /**
- * prune non-loop blocks on reaching the count of join misses (0 means disabled)
+ * prune retained non-loop blocks on reaching the count of states (0 means
+ * disabled), other non-loop blocks are pruned as soon as they are processed
  */
-#define SE_STATE_PRUNING_MISS_THR           0x20
+#define SE_STATE_PRUNING_TOTAL_THR          0x80
 
 /**
- * prune non-loop blocks on reaching the count of states (0 means disabled)
+ * compact the file with spilled states (see the spill_budget plug-in argument)
+ * once it contains at least this many bytes of reloaded heaps and they occupy
+ * more space than the heaps that are still spilled
  */
-#define SE_STATE_PRUNING_TOTAL_THR          0x80
+#define SE_SPILL_COMPACT_THR                0x100000
 
 /**
  * if 1, the symcut module allows generic minimal lengths to survive a function
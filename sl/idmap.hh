@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_IDMAP_H
+#define H_GUARD_IDMAP_H
+
+/**
+ * @file idmap.hh
+ * IdMap - a dense, vector-backed replacement of std::map<TId, TVal> for IDs
+ */
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * map with integral keys (IDs) backed by plain arrays indexed by the IDs
+ *
+ * IDs of SymHeap entities are small consecutive integers, so a lookup is just
+ * an array access.  Each slot carries a generation stamp, so clear() is O(1).
+ * The arrays are recycled through a pool once an IdMap is destroyed, which
+ * means that creating a temporary IdMap does not allocate in the steady state.
+ *
+ * Only the subset of the std::map API used by the symbolic execution is
+ * provided.  Iterators are plain pointers (0 stands for end()) and they are
+ * invalidated by insertion of a key greater than any key inserted before.
+ */
+template <typename TId, typename TVal>
+class IdMap {
+    public:
+        typedef TId                                 key_type;
+        typedef TVal                                mapped_type;
+        typedef std::pair<TId, TVal>                value_type;
+        typedef value_type                         *iterator;
+        typedef const value_type                   *const_iterator;
+
+    private:
+        struct Slot {
+            unsigned                gen;
+            value_type              kv;
+
+            Slot(): gen(0U) { }
+        };
+
+        typedef std::vector<Slot>                   TSlots;
+
+        /// slots of non-negative and negative IDs, recycled through the pool
+        struct Storage {
+            TSlots                  pos;
+            TSlots                  neg;
+            unsigned                gen;
+
+            Storage(): gen(0U) { }
+        };
+
+        typedef std::vector<Storage *>              TPool;
+
+        static TPool& pool() {
+            static TPool pool;
+            return pool;
+        }
+
+        Storage                    *st_;
+        unsigned                    size_;
+
+        void acquire() {
+            TPool &pl = pool();
+            if (pl.empty()) {
+                st_ = new Storage;
+            }
+            else {
+                st_ = pl.back();
+                pl.pop_back();
+            }
+
+            this->bumpGen();
+        }
+
+        void bumpGen() {
+            size_ = 0U;
+            if (++st_->gen)
+                return;
+
+            // generation counter wrapped around, wipe the stamps explicitly
+            std::fill(st_->pos.begin(), st_->pos.end(), Slot());
+            std::fill(st_->neg.begin(), st_->neg.end(), Slot());
+            st_->gen = 1U;
+        }
+
+        Slot* slotAt(const TId id) const {
+            const long idx = static_cast<long>(id);
+            const TSlots &slots = (0 <= idx) ? st_->pos : st_->neg;
+            const size_t pos = (0 <= idx) ? idx : (-idx - 1);
+            if (slots.size() <= pos)
+                return 0;
+
+            return const_cast<Slot *>(&slots[pos]);
+        }
+
+        Slot& slotFor(const TId id) {
+            const long idx = static_cast<long>(id);
+            TSlots &slots = (0 <= idx) ? st_->pos : st_->neg;
+            const size_t pos = (0 <= idx) ? idx : (-idx - 1);
+            if (slots.size() <= pos)
+                slots.resize(std::max(pos + 1U, slots.size() << 1));
+
+            return slots[pos];
+        }
+
+        void copyFrom(const IdMap &ref) {
+            const TSlots *const tabs[] = { &ref.st_->pos, &ref.st_->neg };
+            for (unsigned i = 0U; i < 2U; ++i) {
+                const TSlots &slots = *tabs[i];
+                for (unsigned j = 0U; j < slots.size(); ++j)
+                    if (ref.st_->gen == slots[j].gen)
+                        (*this)[slots[j].kv.first] = slots[j].kv.second;
+            }
+        }
+
+    public:
+        IdMap() {
+            this->acquire();
+        }
+
+        IdMap(const IdMap &ref) {
+            this->acquire();
+            this->copyFrom(ref);
+        }
+
+        IdMap& operator=(const IdMap &ref) {
+            if (&ref != this) {
+                this->clear();
+                this->copyFrom(ref);
+            }
+
+            return *this;
+        }
+
+        ~IdMap() {
+            pool().push_back(st_);
+        }
+
+        unsigned size() const { return size_; }
+        bool empty() const { return !size_; }
+
+        /// remove all items in O(1), the allocated storage is kept
+        void clear() {
+            this->bumpGen();
+        }
+
+        iterator end() { return 0; }
+        const_iterator end() const { return 0; }
+
+        iterator find(const TId id) {
+            Slot *slot = this->slotAt(id);
+            return (slot && st_->gen == slot->gen)
+                ? &slot->kv
+                : 0;
+        }
+
+        const_iterator find(const TId id) const {
+            return const_cast<IdMap *>(this)->find(id);
+        }
+
+        TVal& operator[](const TId id) {
+            Slot &slot = this->slotFor(id);
+            if (st_->gen != slot.gen) {
+                slot.gen = st_->gen;
+                slot.kv = value_type(id, TVal());
+                ++size_;
+            }
+
+            return slot.kv.second;
+        }
+
+        std::pair<iterator, bool> insert(const value_type &item) {
+            iterator it = this->find(item.first);
+            if (it)
+                return std::make_pair(it, false);
+
+            (*this)[item.first] = item.second;
+            return std::make_pair(this->find(item.first), true);
+        }
+};
+
+#endif /* H_GUARD_IDMAP_H */
@@ -22,27 +22,46 @@
 
 #include <cl/cl_msg.hh>
 
+#include <fstream>
 #include <iomanip>
 
-#if DEBUG_MEM_USAGE
+#include <unistd.h>
+
+#ifndef HAVE_MALLINFO2
+#   define HAVE_MALLINFO2 0
+#endif
+
+#if HAVE_MALLINFO2
 #   include <malloc.h>
+#endif
+
+static bool rawMemUsageCore(ssize_t *pDst)
+{
+#if HAVE_MALLINFO2
+    // unlike mallinfo(), mallinfo2() does not overflow beyond 2 GiB
+    const struct mallinfo2 info = mallinfo2();
+    *pDst = info.uordblks + info.hblkhd;
+    return true;
+#else
+    // fall back to the resident set size as reported by the kernel
+    std::ifstream statm("/proc/self/statm");
+    ssize_t size, resident;
+    if (!(statm >> size >> resident))
+        return false;
+
+    static const ssize_t pageSize = sysconf(_SC_PAGESIZE);
+    *pDst = resident * pageSize;
+    return true;
+#endif
+}
 
-static bool overflowDetected;
 static ssize_t peak;
 
 bool rawMemUsage(ssize_t *pDst)
 {
-    if (::overflowDetected)
-        return false;
-
-    struct mallinfo info = mallinfo();
-    const ssize_t raw = info.uordblks;
-    const unsigned mib = raw >> /* MiB */ 20;
-    if (2048U < mib) {
-        // mallinfo() is broken by design <https://bugzilla.redhat.com/173813>
-        ::overflowDetected = true;
+    ssize_t raw;
+    if (!rawMemUsageCore(&raw))
         return false;
-    }
 
     *pDst = raw;
     if (peak < raw)
@@ -53,11 +72,19 @@ bool rawMemUsage(ssize_t *pDst)
 }
 
 static ssize_t memDrift;
+static bool codeStorageAccounted;
 
 bool initMemDrift()
 {
-    if (rawMemUsage(&::memDrift))
+    if (rawMemUsage(&::memDrift)) {
+        if (!::codeStorageAccounted) {
+            // whatever has been allocated so far belongs to Code Listener
+            memAccount(MS_CODE_STORAGE, /* cntObjs */ 0, ::memDrift);
+            ::codeStorageAccounted = true;
+        }
+
         return true;
+    }
 
     // failed to get current memory usage
     ::memDrift = 0U;
@@ -102,7 +129,7 @@ std::ostream& operator<<(std::ostream &str, const AmountFormatter &fmt)
     return str;
 }
 
-#include <iostream>
+#if DEBUG_MEM_USAGE
 bool printMemUsage(const char *fnc)
 {
     ssize_t cb;
@@ -121,9 +148,6 @@ bool printMemUsage(const char *fnc)
 
 bool printPeakMemUsage()
 {
-    if (::overflowDetected)
-        return false;
-
     const ssize_t diff = ::peak - ::memDrift;
     CL_NOTE("peak memory usage: " << AmountFormatter(diff,
                 /* MiB */ 20,
@@ -136,29 +160,67 @@ bool printPeakMemUsage()
 
 #else // DEBUG_MEM_USAGE
 
-bool rawMemUsage(ssize_t *)
+bool printMemUsage(const char *)
 {
     return false;
 }
 
-bool initMemDrift()
+bool printPeakMemUsage()
 {
     return false;
 }
 
-bool currentMemUsage(ssize_t *)
+#endif
+
+struct MemAccount {
+    ssize_t     cntObjs;
+    ssize_t     cntBytes;
+};
+
+static MemAccount memAccounts[MS_LAST];
+
+static const char *memSubsystemNames[] = {
+    "CodeStorage",
+    "SymStateMap",
+    "SymCallCache",
+    "trace graph"
+};
+
+void memAccount(EMemSubsystem ms, int cntObjs, ssize_t cntBytes)
 {
-    return false;
+    MemAccount &acc = ::memAccounts[ms];
+    acc.cntObjs     += cntObjs;
+    acc.cntBytes    += cntBytes;
 }
 
-bool printMemUsage(const char *)
+ssize_t memAccounted(EMemSubsystem ms)
 {
-    return false;
+    return ::memAccounts[ms].cntBytes;
 }
 
-bool printPeakMemUsage()
+void printMemAccounting()
 {
-    return false;
+    for (int i = 0; i < MS_LAST; ++i) {
+        const MemAccount &acc = ::memAccounts[i];
+        CL_DEBUG("estimated memory usage of " << memSubsystemNames[i] << ": "
+                << AmountFormatter(acc.cntBytes,
+                    /* MiB */ 20,
+                    /* int digits */ 4,
+                    /* dec digits */ 2)
+                << " MB (" << acc.cntObjs << " objects)");
+    }
 }
 
-#endif
+bool memBudgetExceeded(size_t budget)
+{
+    if (!budget)
+        // unlimited
+        return false;
+
+    ssize_t cb;
+    if (!rawMemUsage(&cb))
+        // we do not know, so we assume it is not exceeded
+        return false;
+
+    return static_cast<size_t>(cb) > budget;
+}
@@ -22,12 +22,26 @@
 
 #include <string>
 
+#include <sys/types.h>
+
 /**
  * @file memdebug.hh
- * @todo some dox
+ * memory accounting of the analyzer.  The raw amount of allocated memory is
+ * obtained from glibc (mallinfo2) if available, from /proc/self/statm
+ * otherwise.  On top of that, we keep an estimated count of bytes per each
+ * subsystem that is known to be memory hungry.
  */
 
-/// provide the raw amount of currently allocated memory (as glibc reports it)
+/// memory hungry subsystems, which we keep estimated memory consumption of
+enum EMemSubsystem {
+    MS_CODE_STORAGE = 0,    ///< CodeStorage::Storage built by Code Listener
+    MS_STATE_MAP,           ///< symbolic heaps kept in SymStateMap
+    MS_CALL_CACHE,          ///< symbolic heaps kept in SymCallCache
+    MS_TRACE_GRAPH,         ///< nodes of the trace graph
+    MS_LAST                 ///< just a sentinel, not a real subsystem
+};
+
+/// provide the raw amount of currently allocated memory
 bool rawMemUsage(ssize_t *pDst);
 
 /// initialize memory debugging, taking the current memory state as state zero
@@ -42,4 +56,25 @@ bool printMemUsage(const char *justCompletedFncName);
 /// print the peak over all calls of rawMemUsage(), but relative to the drift
 bool printPeakMemUsage();
 
+/**
+ * account objects allocated by the given subsystem
+ * @param ms the subsystem that allocated (or released) the objects
+ * @param cntObjs count of objects allocated, negative if released
+ * @param cntBytes estimated count of bytes allocated, negative if released
+ */
+void memAccount(EMemSubsystem ms, int cntObjs, ssize_t cntBytes);
+
+/// return the estimated count of bytes currently allocated by the subsystem
+ssize_t memAccounted(EMemSubsystem ms);
+
+/// print the estimated amount of memory per subsystem (in verbose mode)
+void printMemAccounting();
+
+/**
+ * check whether the current memory usage exceeds the given budget
+ * @param budget memory budget in bytes, zero means unlimited
+ * @return true if the budget is known to be exceeded
+ */
+bool memBudgetExceeded(size_t budget);
+
 #endif /* H_GUARD_MEM_DEBUG_H */
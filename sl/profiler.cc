@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "profiler.hh"
+
+#include <cl/cl_msg.hh>
+#include <cl/code_listener.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+#include <time.h>
+
+#include <boost/foreach.hpp>
+
+/// count of the most expensive functions/blocks printed by Profiler::dump()
+#define PROF_TOP_N 0x10
+
+typedef unsigned long long TUsec;
+
+static const char *phaseNames[] = {
+    "exec",
+    "join",
+    "areEqual",
+    "abstract",
+    "symcut",
+    "gc",
+    "callCache",
+    "plot"
+};
+
+static const char *insnNames[] = {
+    "insn_nop",
+    "insn_jmp",
+    "insn_cond",
+    "insn_ret",
+    "insn_abort",
+    "insn_unop",
+    "insn_binop",
+    "insn_call",
+    "insn_switch",
+    "insn_label"
+};
+
+static const int insnNamesCnt = sizeof(insnNames)/sizeof(*insnNames);
+
+static TUsec now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<TUsec>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+struct PhaseStats {
+    unsigned long long      cnt;
+    TUsec                   total;      ///< inclusive time
+    TUsec                   start;
+    int                     depth;      ///< to handle recursive phases
+
+    PhaseStats():
+        cnt(0),
+        total(0),
+        start(0),
+        depth(0)
+    {
+    }
+};
+
+struct ProfFrame {
+    size_t                  keyLen;     ///< length of the key before push
+    bool                    isFnc;
+    bool                    isPhase;
+    std::string             name;
+};
+
+struct ProfData {
+    typedef std::map<std::string, TUsec>        TTimeMap;
+    typedef std::vector<ProfFrame>              TStack;
+
+    std::string             foldedFile;
+    std::string             key;        ///< the current stack in folded form
+    TStack                  stack;
+    TUsec                   lastTs;
+
+    TTimeMap                folded;
+    TTimeMap                byFnc;
+    TTimeMap                byBlock;
+
+    PhaseStats              phases[PP_LAST];
+    PhaseStats              insns[insnNamesCnt];
+
+    ProfData():
+        lastTs(now())
+    {
+    }
+
+    void flush();
+    void push(const std::string &name, bool isFnc, bool isPhase);
+    void pop();
+};
+
+static ProfData *data;
+
+bool Profiler::enabled_;
+
+// account the time elapsed since the last change of the stack to the stack
+void ProfData::flush()
+{
+    const TUsec ts = now();
+    const TUsec elapsed = ts - this->lastTs;
+    this->lastTs = ts;
+    if (!elapsed)
+        return;
+
+    this->folded[(this->key.empty()) ? "<root>" : this->key] += elapsed;
+
+    // find the innermost function and basic block
+    const ProfFrame *fnc = 0;
+    const ProfFrame *bb = 0;
+    BOOST_REVERSE_FOREACH(const ProfFrame &frame, this->stack) {
+        if (frame.isPhase)
+            continue;
+
+        if (frame.isFnc) {
+            fnc = &frame;
+            break;
+        }
+
+        if (!bb)
+            bb = &frame;
+    }
+
+    if (!fnc)
+        return;
+
+    this->byFnc[fnc->name] += elapsed;
+    if (bb)
+        this->byBlock[fnc->name + ":" + bb->name] += elapsed;
+}
+
+void ProfData::push(const std::string &name, bool isFnc, bool isPhase)
+{
+    this->flush();
+
+    ProfFrame frame;
+    frame.keyLen    = this->key.size();
+    frame.isFnc     = isFnc;
+    frame.isPhase   = isPhase;
+    frame.name      = name;
+    this->stack.push_back(frame);
+
+    if (!this->key.empty())
+        this->key += ';';
+
+    this->key += name;
+}
+
+void ProfData::pop()
+{
+    if (this->stack.empty()) {
+        CL_BREAK_IF("Profiler: attempt to pop from an empty stack");
+        return;
+    }
+
+    this->flush();
+    this->key.resize(this->stack.back().keyLen);
+    this->stack.pop_back();
+}
+
+void Profiler::enable(const std::string &foldedFile)
+{
+    if (!::data)
+        ::data = new ProfData;
+
+    ::data->foldedFile = foldedFile;
+    enabled_ = true;
+}
+
+void Profiler::pushFrame(const std::string &name, bool isFnc)
+{
+    ::data->push(name, isFnc, /* isPhase */ false);
+}
+
+void Profiler::popFrame()
+{
+    ::data->pop();
+}
+
+static void enterStats(PhaseStats &stats, const TUsec ts)
+{
+    ++stats.cnt;
+    if (!stats.depth++)
+        stats.start = ts;
+}
+
+static void leaveStats(PhaseStats &stats, const TUsec ts)
+{
+    CL_BREAK_IF(stats.depth <= 0);
+    if (!--stats.depth)
+        stats.total += ts - stats.start;
+}
+
+void Profiler::enterPhase(EProfPhase phase, int detail)
+{
+    ProfData &pd = *::data;
+    const bool isInsn = (PP_EXEC_INSN == phase)
+        && (0 <= detail) && (detail < insnNamesCnt);
+
+    const char *name = (isInsn)
+        ? insnNames[detail]
+        : phaseNames[phase];
+
+    pd.push(name, /* isFnc */ false, /* isPhase */ true);
+
+    enterStats(pd.phases[phase], pd.lastTs);
+    if (isInsn)
+        enterStats(pd.insns[detail], pd.lastTs);
+}
+
+void Profiler::leavePhase(EProfPhase phase, int detail)
+{
+    ProfData &pd = *::data;
+    pd.pop();
+
+    leaveStats(pd.phases[phase], pd.lastTs);
+    if ((PP_EXEC_INSN == phase) && (0 <= detail) && (detail < insnNamesCnt))
+        leaveStats(pd.insns[detail], pd.lastTs);
+}
+
+static void printPhase(const char *name, const PhaseStats &stats)
+{
+    if (!stats.cnt)
+        return;
+
+    CL_NOTE("profiler: " << std::setw(12) << name
+            << std::setw(12) << stats.cnt << " call(s), "
+            << std::fixed << std::setprecision(3)
+            << (stats.total / 1000000.0) << " s");
+}
+
+static void printTopN(const char *what, const ProfData::TTimeMap &tmap)
+{
+    typedef std::pair<TUsec, std::string> TItem;
+    std::vector<TItem> items;
+    BOOST_FOREACH(ProfData::TTimeMap::const_reference ref, tmap)
+        items.push_back(TItem(ref.second, ref.first));
+
+    std::sort(items.rbegin(), items.rend());
+    if (PROF_TOP_N < items.size())
+        items.resize(PROF_TOP_N);
+
+    BOOST_FOREACH(const TItem &item, items) {
+        CL_NOTE("profiler: " << what << " " << item.second << ": "
+                << std::fixed << std::setprecision(3)
+                << (item.first / 1000000.0) << " s (self)");
+    }
+}
+
+bool Profiler::dump()
+{
+    if (!enabled_)
+        return false;
+
+    ProfData &pd = *::data;
+    pd.flush();
+
+    for (int i = 0; i < PP_LAST; ++i)
+        printPhase(phaseNames[i], pd.phases[i]);
+
+    for (int i = 0; i < insnNamesCnt; ++i)
+        printPhase(insnNames[i], pd.insns[i]);
+
+    printTopN("fnc", pd.byFnc);
+    printTopN("block", pd.byBlock);
+
+    if (pd.foldedFile.empty())
+        return true;
+
+    std::fstream out(pd.foldedFile.c_str(), std::ios::out);
+    if (!out) {
+        CL_ERROR("unable to create file '" << pd.foldedFile << "'");
+        return false;
+    }
+
+    BOOST_FOREACH(ProfData::TTimeMap::const_reference ref, pd.folded)
+        out << ref.first << " " << ref.second << "\n";
+
+    out.close();
+    if (!out) {
+        CL_ERROR("error while writing file '" << pd.foldedFile << "'");
+        return false;
+    }
+
+    CL_NOTE("profiler: folded stacks written to '" << pd.foldedFile << "'");
+    return true;
+}
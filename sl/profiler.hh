@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_PROFILER_H
+#define H_GUARD_PROFILER_H
+
+/**
+ * @file profiler.hh
+ * built-in profiler of the symbolic execution, enabled at run-time by the
+ * @b profile plug-in argument.  It maintains a stack of frames (functions,
+ * basic blocks and phases of the analysis) and accounts the time spent in
+ * each of them.  The result can be dumped as @b folded @b stacks, one stack
+ * per line followed by the count of microseconds spent there, which is the
+ * input format of flamegraph.pl and similar tools.
+ */
+
+#include <string>
+
+/// phases of the symbolic execution the profiler accounts separately
+enum EProfPhase {
+    PP_EXEC_INSN = 0,       ///< execution of a single insn on a single heap
+    PP_JOIN,                ///< joinSymHeaps()
+    PP_ARE_EQUAL,           ///< areEqual()
+    PP_ABSTRACT,            ///< abstractIfNeeded()
+    PP_SYMCUT,              ///< splitHeapByCVars(), joinHeapsByCVars()
+    PP_GC,                  ///< garbage collection of unreachable objects
+    PP_CALL_CACHE,          ///< SymCallCache lookup
+    PP_PLOT,                ///< plotHeap() and plotting of trace graphs
+    PP_LAST                 ///< just a sentinel, not a real phase
+};
+
+class Profiler {
+    public:
+        /**
+         * enable the profiler
+         * @param foldedFile if not empty, dump the folded stacks to this file
+         * once Profiler::dump() is called
+         */
+        static void enable(const std::string &foldedFile);
+
+        /// true if the profiler is enabled, the check is supposed to be cheap
+        static bool enabled() {
+            return enabled_;
+        }
+
+        /// push a frame (a function or a basic block) on the profiling stack
+        static void pushFrame(const std::string &name, bool isFnc);
+
+        /// pop the frame from top of the profiling stack
+        static void popFrame();
+
+        /**
+         * enter a phase of the analysis
+         * @param detail an optional detail of the phase (for PP_EXEC_INSN this
+         * is the instruction code), -1 if not used
+         */
+        static void enterPhase(EProfPhase phase, int detail = -1);
+
+        /// leave a phase previously entered by enterPhase()
+        static void leavePhase(EProfPhase phase, int detail = -1);
+
+        /// print the collected statistics and write the folded stacks if asked
+        static bool dump();
+
+    private:
+        /// library class
+        Profiler();
+
+        static bool enabled_;
+};
+
+/// RAII helper accounting a phase of the analysis (does nothing if disabled)
+class ProfScope {
+    public:
+        ProfScope(const EProfPhase phase, const int detail = -1):
+            active_(Profiler::enabled()),
+            phase_(phase),
+            detail_(detail)
+        {
+            if (active_)
+                Profiler::enterPhase(phase_, detail_);
+        }
+
+        ~ProfScope() {
+            if (active_)
+                Profiler::leavePhase(phase_, detail_);
+        }
+
+    private:
+        // not implemented
+        ProfScope(const ProfScope &);
+        ProfScope& operator=(const ProfScope &);
+
+        const bool          active_;
+        const EProfPhase    phase_;
+        const int           detail_;
+};
+
+/// RAII helper to push a basic block on the profiling stack
+class ProfBlockScope {
+    public:
+        ProfBlockScope(const std::string &name):
+            active_(Profiler::enabled())
+        {
+            if (active_)
+                Profiler::pushFrame(name, /* isFnc */ false);
+        }
+
+        ~ProfBlockScope() {
+            if (active_)
+                Profiler::popFrame();
+        }
+
+    private:
+        // not implemented
+        ProfBlockScope(const ProfBlockScope &);
+        ProfBlockScope& operator=(const ProfBlockScope &);
+
+        const bool          active_;
+};
+
+#endif /* H_GUARD_PROFILER_H */
@@ -25,7 +25,9 @@
 #include <cl/clutil.hh>
 #include <cl/storage.hh>
 
+#include "profiler.hh"
 #include "prototype.hh"
+#include "symcapture.hh"
 #include "symcmp.hh"
 #include "symdebug.hh"
 #include "symjoin.hh"
@@ -622,6 +624,8 @@ void abstractIfNeeded(SymHeap &sh)
 #if SE_DISABLE_SLS && SE_DISABLE_DLS
     return;
 #endif
+    ProfScope prof(PP_ABSTRACT);
+    CaptureScope cap(CO_ABSTRACT, sh);
     BindingOff          off;
     TValId              entry;
     unsigned            len;
@@ -634,6 +638,9 @@ void abstractIfNeeded(SymHeap &sh)
         // some part of the symbolic heap has just been successfully abstracted,
         // let's look if there remains anything else suitable for abstraction
     }
+
+    if (cap.active())
+        cap.setOutcome(captureOutcomeOf(sh));
 }
 
 void concretizeObj(
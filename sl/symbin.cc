@@ -21,6 +21,7 @@
 #include "symbin.hh"
 
 #include <cl/cl_msg.hh>
+#include <cl/clutil.hh>
 #include <cl/storage.hh>
 
 // we are mainly interested in the declaration of enum ___sl_module_id
@@ -937,11 +938,24 @@ bool handleError(
     return true;
 }
 
+typedef bool (*THandler)(
+        SymState                                    &dst,
+        SymExecCore                                 &core,
+        const CodeStorage::Insn                     &insn,
+        const char                                  *name);
+
+struct BuiltIn {
+    THandler                                        hdl;
+    TOpIdxList                                      derefs;
+
+    BuiltIn():
+        hdl(0)
+    {
+    }
+};
+
 // singleton
 class BuiltInTable {
-    public:
-        typedef const CodeStorage::Insn             &TInsn;
-
     public:
         static BuiltInTable* inst() {
             return (inst_)
@@ -949,14 +963,7 @@ class BuiltInTable {
                 : (inst_ = new BuiltInTable);
         }
 
-        bool handleBuiltIn(
-                SymState                            &dst,
-                SymExecCore                         &core,
-                TInsn                                insn,
-                const char                          *name)
-            const;
-
-        const TOpIdxList& lookForDerefs(const char *name) const;
+        const BuiltIn* lookup(const char *name) const;
 
         // TODO: rename and hide
         const TOpIdxList                            emp_;
@@ -966,17 +973,11 @@ class BuiltInTable {
 
         static BuiltInTable* inst_;
 
-        typedef bool (*THandler)(
-                SymState                            &dst,
-                SymExecCore                         &core,
-                const CodeStorage::Insn             &insn,
-                const char                          *name);
-
-        typedef std::map<std::string, THandler>     TMap;
+        typedef std::map<std::string, BuiltIn>      TMap;
         TMap                                        tbl_;
 
-        typedef std::map<std::string, TOpIdxList>   TDerefMap;
-        TDerefMap                                   der_;
+        /// used for all the __VERIFIER_nondet_* functions
+        BuiltIn                                     nondet_;
 };
 
 BuiltInTable *BuiltInTable::inst_;
@@ -985,100 +986,90 @@ BuiltInTable *BuiltInTable::inst_;
 BuiltInTable::BuiltInTable()
 {
     // GCC built-in stack allocation
-    tbl_["__builtin_alloca"] /* before GCC 4.7.0 */ = handleAlloca;
-    tbl_["__builtin_alloca_with_align"]             = handleAlloca;
-    tbl_["__builtin_stack_restore"]                 = handleStackRestore;
-    tbl_["__builtin_stack_save"]                    = handleStackSave;
+    tbl_["__builtin_alloca"] /* before GCC 4.7.0 */ .hdl = handleAlloca;
+    tbl_["__builtin_alloca_with_align"]             .hdl = handleAlloca;
+    tbl_["__builtin_stack_restore"]                 .hdl = handleStackRestore;
+    tbl_["__builtin_stack_save"]                    .hdl = handleStackSave;
 
     // C run-time
-    tbl_["abort"]                                   = handleAbort;
-    tbl_["calloc"]                                  = handleCalloc;
-    tbl_["free"]                                    = handleFree;
-    tbl_["malloc"]                                  = handleMalloc;
-    tbl_["memcpy"]                                  = handleMemcpy;
-    tbl_["memmove"]                                 = handleMemmove;
-    tbl_["memset"]                                  = handleMemset;
-    tbl_["printf"]                                  = handlePrintf;
-    tbl_["puts"]                                    = handlePuts;
-    tbl_["strlen"]                                  = handleStrlen;
-    tbl_["strncpy"]                                 = handleStrncpy;
+    tbl_["abort"]                                   .hdl = handleAbort;
+    tbl_["calloc"]                                  .hdl = handleCalloc;
+    tbl_["free"]                                    .hdl = handleFree;
+    tbl_["malloc"]                                  .hdl = handleMalloc;
+    tbl_["memcpy"]                                  .hdl = handleMemcpy;
+    tbl_["memmove"]                                 .hdl = handleMemmove;
+    tbl_["memset"]                                  .hdl = handleMemset;
+    tbl_["printf"]                                  .hdl = handlePrintf;
+    tbl_["puts"]                                    .hdl = handlePuts;
+    tbl_["strlen"]                                  .hdl = handleStrlen;
+    tbl_["strncpy"]                                 .hdl = handleStrncpy;
 
     // Linux kernel
-    tbl_["kzalloc"]                                 = handleKzalloc;
+    tbl_["kzalloc"]                                 .hdl = handleKzalloc;
 
     // Predator-specific
-    tbl_["___sl_break"]                             = handleBreak;
-    tbl_["___sl_error"]                             = handleError;
-    tbl_["___sl_get_nondet_int"]                    = handleNondetInt;
-    tbl_["___sl_plot"]                              = handlePlot;
-    tbl_["___sl_plot_trace_now"]                    = handlePlotTraceNow;
-    tbl_["___sl_plot_trace_once"]                   = handlePlotTraceOnce;
-    tbl_["___sl_enable_debugging_of"]               = handleDebuggingOf;
+    tbl_["___sl_break"]                             .hdl = handleBreak;
+    tbl_["___sl_error"]                             .hdl = handleError;
+    tbl_["___sl_get_nondet_int"]                    .hdl = handleNondetInt;
+    tbl_["___sl_plot"]                              .hdl = handlePlot;
+    tbl_["___sl_plot_trace_now"]                    .hdl = handlePlotTraceNow;
+    tbl_["___sl_plot_trace_once"]                   .hdl = handlePlotTraceOnce;
+    tbl_["___sl_enable_debugging_of"]               .hdl = handleDebuggingOf;
 
     // used in the Competition on Software Verification held at TACAS
-    tbl_["__VERIFIER_assume"]                       = handleAssume;
-    //    __VERIFIER_nondet_*   functions are handled in the above layer
+    tbl_["__VERIFIER_assume"]                       .hdl = handleAssume;
+    nondet_                                         .hdl = handleNondetInt;
 
     // just to make life easier to our competitors (TODO: check for collisions)
-    tbl_["__nondet"]                                = handleNondetInt;
-    tbl_["nondet_int"]                              = handleNondetInt;
-    tbl_["undef_int"]                               = handleNondetInt;
-
-    // initialize lookForDerefs() look-up table
-    der_["free"]        .push_back(/* addr */ 2);
-    der_["memcpy"]      .push_back(/* dst  */ 2);
-    der_["memcpy"]      .push_back(/* src  */ 3);
-    der_["memmove"]     .push_back(/* dst  */ 2);
-    der_["memmove"]     .push_back(/* src  */ 3);
-    der_["memset"]      .push_back(/* addr */ 2);
+    tbl_["__nondet"]                                .hdl = handleNondetInt;
+    tbl_["nondet_int"]                              .hdl = handleNondetInt;
+    tbl_["undef_int"]                               .hdl = handleNondetInt;
+
+    // operands with dereference semantics
+    tbl_["free"]        .derefs.push_back(/* addr */ 2);
+    tbl_["memcpy"]      .derefs.push_back(/* dst  */ 2);
+    tbl_["memcpy"]      .derefs.push_back(/* src  */ 3);
+    tbl_["memmove"]     .derefs.push_back(/* dst  */ 2);
+    tbl_["memmove"]     .derefs.push_back(/* src  */ 3);
+    tbl_["memset"]      .derefs.push_back(/* addr */ 2);
     // TODO: printf
-    der_["puts"]        .push_back(/* s    */ 2);
-    der_["strlen"]      .push_back(/* s    */ 2);
-    der_["strncpy"]     .push_back(/* dst  */ 2);
-    der_["strncpy"]     .push_back(/* src  */ 3);
+    tbl_["puts"]        .derefs.push_back(/* s    */ 2);
+    tbl_["strlen"]      .derefs.push_back(/* s    */ 2);
+    tbl_["strncpy"]     .derefs.push_back(/* dst  */ 2);
+    tbl_["strncpy"]     .derefs.push_back(/* src  */ 3);
 }
 
-bool BuiltInTable::handleBuiltIn(
-        SymState                                    &dst,
-        SymExecCore                                 &core,
-        const CodeStorage::Insn                     &insn,
-        const char                                  *name)
-    const
+const BuiltIn* BuiltInTable::lookup(const char *name) const
 {
-    THandler hdl;
-
     TMap::const_iterator it = tbl_.find(name);
-    if (tbl_.end() == it) {
-        static const char namePrefixNondet[] = "__VERIFIER_nondet_";
-        static const size_t namePrefixLength = sizeof(namePrefixNondet) - 1U;
-        std::string namePrefix(name);
-        if (namePrefixLength < namePrefix.size())
-            namePrefix.resize(namePrefixLength);
-
-        if (std::string(namePrefixNondet) == namePrefix)
-            hdl = handleNondetInt;
-        else
-            // no fnc name matched as built-in
-            return false;
-    }
-    else
-        hdl = it->second;
+    if (tbl_.end() != it)
+        return &it->second;
 
-    SymHeap &sh = core.sh();
-    SymDumpRefHeap shRef(&sh);
-    sh.traceUpdate(new Trace::InsnNode(sh.traceNode(), &insn, /* bin */ true));
+    static const char namePrefixNondet[] = "__VERIFIER_nondet_";
+    static const size_t namePrefixLength = sizeof(namePrefixNondet) - 1U;
+    if (!strncmp(name, namePrefixNondet, namePrefixLength))
+        return &nondet_;
 
-    return hdl(dst, core, insn, name);
+    // no fnc name matched as built-in
+    return 0;
 }
 
-const TOpIdxList& BuiltInTable::lookForDerefs(const char *name) const
+bool fncNameFromUid(
+        const char                                **pName,
+        const CodeStorage::Storage                  &stor,
+        const int                                   uid)
 {
-    TDerefMap::const_iterator it = der_.find(name);
-    if (der_.end() == it)
-        // no fnc name matched as built-in
-        return emp_;
+    const CodeStorage::Fnc *fnc = stor.fncs[uid];
+    if (!fnc->def.data.cst.data.cst_fnc.is_extern)
+        // only external functions are candidates for built-in functions
+        return false;
 
-    return it->second;
+    const char *name = nameOf(*fnc);
+    if (!name)
+        return false;
+
+    *pName = name;
+    return true;
 }
 
 bool fncNameFromOp(
@@ -1090,18 +1081,21 @@ bool fncNameFromOp(
     if (!core.fncFromOperand(&uid, op))
         return false;
 
-    const TStorRef stor = core.sh().stor();
-    const CodeStorage::Fnc *fnc = stor.fncs[uid];
-    if (!fnc->def.data.cst.data.cst_fnc.is_extern)
-        // only external functions are candidates for built-in functions
-        return false;
+    return fncNameFromUid(pName, core.sh().stor(), uid);
+}
 
-    const char *name = nameOf(*fnc);
-    if (!name)
-        return false;
+bool execBuiltIn(
+        SymState                                    &dst,
+        SymExecCore                                 &core,
+        const CodeStorage::Insn                     &insn,
+        const BuiltIn                               &bi,
+        const char                                  *name)
+{
+    SymHeap &sh = core.sh();
+    SymDumpRefHeap shRef(&sh);
+    sh.traceUpdate(new Trace::InsnNode(sh.traceNode(), &insn, /* bin */ true));
 
-    *pName = name;
-    return true;
+    return bi.hdl(dst, core, insn, name);
 }
 
 bool handleBuiltIn(
@@ -1113,8 +1107,41 @@ bool handleBuiltIn(
     if (!fncNameFromOp(&name, core, insn.operands[/* fnc */ 1]))
         return false;
 
-    const BuiltInTable *tbl = BuiltInTable::inst();
-    return tbl->handleBuiltIn(dst, core, insn, name);
+    const BuiltIn *bi = BuiltInTable::inst()->lookup(name);
+    if (!bi)
+        return false;
+
+    return execBuiltIn(dst, core, insn, *bi, name);
+}
+
+bool resolveBuiltIn(
+        const BuiltIn                              **pBuiltIn,
+        const char                                 **pName,
+        const CodeStorage::Insn                     &insn)
+{
+    int uid;
+    if (!fncUidFromOperand(&uid, &insn.operands[/* fnc */ 1]))
+        // indirect call, needs to be resolved per heap
+        return false;
+
+    *pBuiltIn = 0;
+    *pName = 0;
+
+    const char *name;
+    if (!fncNameFromUid(&name, *insn.stor, uid))
+        // a direct call of a function that cannot be a built-in
+        return true;
+
+    *pBuiltIn = BuiltInTable::inst()->lookup(name);
+    if (*pBuiltIn)
+        *pName = name;
+
+    return true;
+}
+
+const TOpIdxList& opsWithDerefSemantics(const BuiltIn &bi)
+{
+    return bi.derefs;
 }
 
 const TOpIdxList& opsWithDerefSemanticsInCallInsn(
@@ -1127,5 +1154,9 @@ const TOpIdxList& opsWithDerefSemanticsInCallInsn(
     if (!fncNameFromOp(&name, core, insn.operands[/* fnc */ 1]))
         return tbl->emp_;
 
-    return tbl->lookForDerefs(name);
+    const BuiltIn *bi = tbl->lookup(name);
+    if (!bi)
+        return tbl->emp_;
+
+    return bi->derefs;
 }
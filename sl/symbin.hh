@@ -55,4 +55,29 @@ bool handleBuiltIn(SymState                     &dst,
                    SymExecCore                  &core,
                    const CodeStorage::Insn      &insn);
 
+/// a recognized built-in function, opaque outside of symbin
+struct BuiltIn;
+
+/**
+ * resolve the built-in called by the given @b call instruction without looking
+ * at any heap, which is possible for direct calls only
+ * @param pBuiltIn the built-in is stored there, or 0 if the callee is not one
+ * @param pName name of the built-in is stored there (if any)
+ * @param insn a @b call instruction
+ * @return false if the callee is not known statically (an indirect call)
+ */
+bool resolveBuiltIn(const BuiltIn              **pBuiltIn,
+                    const char                 **pName,
+                    const CodeStorage::Insn     &insn);
+
+/// list of operands which have dereference semantics for the given built-in
+const TOpIdxList& opsWithDerefSemantics(const BuiltIn &bi);
+
+/// handleBuiltIn() for a built-in already resolved by resolveBuiltIn()
+bool execBuiltIn(SymState                       &dst,
+                 SymExecCore                    &core,
+                 const CodeStorage::Insn        &insn,
+                 const BuiltIn                  &bi,
+                 const char                     *name);
+
 #endif /* H_GUARD_SYM_BIN_H */
@@ -23,6 +23,8 @@
 #include <cl/cl_msg.hh>
 #include <cl/storage.hh>
 
+#include "memdebug.hh"
+#include "profiler.hh"
 #include "symabstract.hh"
 #include "symbt.hh"
 #include "symcmp.hh"
@@ -37,6 +39,7 @@
 #include "util.hh"
 
 #include <algorithm>
+#include <set>
 #include <vector>
 
 #include <boost/foreach.hpp>
@@ -55,8 +58,11 @@ class PerFncCache {
         SymCallCtx     *null_;
 #endif
         int             missCntSinceLastHit_;
+        unsigned long   lastUse_;
+        bool            generalize_;
 
         int lookupCore(const SymHeap &sh);
+        int lookupCovering(const SymHeap &sh);
 
         void cacheHit() {
             if (0 < missCntSinceLastHit_)
@@ -67,7 +73,9 @@ class PerFncCache {
 
     public:
         PerFncCache():
-            missCntSinceLastHit_(0)
+            missCntSinceLastHit_(0),
+            lastUse_(0UL),
+            generalize_(false)
         {
         }
 
@@ -75,12 +83,35 @@ class PerFncCache {
             BOOST_FOREACH(SymCallCtx *ctx, ctxMap_) {
                 delete ctx;
             }
+
+            BOOST_FOREACH(const SymHeap *sh, huni_)
+                memAccount(MS_CALL_CACHE, -1, -estimateHeapBytes(*sh));
         }
 
         int missCntSinceLastHit() const {
             return missCntSinceLastHit_;
         }
 
+        /// time stamp of the last lookup, as counted by SymCallCache
+        unsigned long lastUse() const {
+            return lastUse_;
+        }
+
+        void touch(const unsigned long now) {
+            lastUse_ = now;
+        }
+
+        /// estimated count of bytes occupied by the entries and their results
+        ssize_t cntBytes() const;
+
+        /**
+         * allow to reuse the results computed for a more general entry heap,
+         * i.e. to use the cached contexts as summaries of the function
+         */
+        void enableGeneralization() {
+            generalize_ = true;
+        }
+
         bool inUse() const {
             BOOST_FOREACH(const SymCallCtx *ctx, ctxMap_)
                 if (ctx->inUse())
@@ -99,6 +130,8 @@ class PerFncCache {
 
             Trace::waiveCloneOperation(by);
             huni_.swapExisting(idx, by);
+            memAccount(MS_CALL_CACHE, 0, estimateHeapBytes(huni_[idx])
+                    - estimateHeapBytes(by));
         }
 
         /**
@@ -129,7 +162,14 @@ int PerFncCache::lookupCore(const SymHeap &sh)
     // try join
     for(idx = 0; idx < cnt; ++idx) {
         const SymHeap &shIn = huni_[idx];
-        if (!joinSymHeaps(&status, &result, shIn, sh))
+        bool needJoin;
+        if (checkEntailment(&status, &needJoin, shIn, sh)) {
+            // already covered by the cached ctx --> cache hit!
+            this->cacheHit();
+            return idx;
+        }
+
+        if (!needJoin || !joinSymHeaps(&status, &result, shIn, sh))
             // join failed with this heap, try the next one
             continue;
 
@@ -156,6 +196,7 @@ int PerFncCache::lookupCore(const SymHeap &sh)
         ctx = 0;
 
         // update the cache entry
+        const ssize_t cntBytesOld = estimateHeapBytes(huni_[idx]);
         if (JS_THREE_WAY == status)
             huni_.swapExisting(idx, result);
         else {
@@ -165,6 +206,9 @@ int PerFncCache::lookupCore(const SymHeap &sh)
             huni_.swapExisting(idx, shDup);
         }
 
+        memAccount(MS_CALL_CACHE, 0,
+                estimateHeapBytes(huni_[idx]) - cntBytesOld);
+
         this->cacheHit();
         return idx;
     }
@@ -180,11 +224,18 @@ int PerFncCache::lookupCore(const SymHeap &sh)
         return idx;
 #   endif
     }
+
+    if (generalize_ && -1 != (idx = this->lookupCovering(sh))) {
+        // the entry is covered by an already computed summary
+        this->cacheHit();
+        return idx;
+    }
 #endif
 
     // cache miss
     idx = ctxMap_.size();
     huni_.insertNew(sh);
+    memAccount(MS_CALL_CACHE, 1, estimateHeapBytes(sh));
     ctxMap_.push_back((SymCallCtx *) 0);
     CL_BREAK_IF(huni_.size() != ctxMap_.size());
 
@@ -201,16 +252,36 @@ struct SymCallCache::Private {
     typedef std::map<int /* uid */, PerFncCache>        TCache;
     typedef std::vector<SymCallCtx *>                   TCtxStack;
 
+    typedef std::set<int /* uid */>                     TFncSet;
+
     TCache                      cache;
     TCtxStack                   ctxStack;
     SymBackTrace                bt;
+    const size_t                budget;
+    const bool                  summaries;
+    unsigned long               clock;
+
+    // statistics
+    unsigned long               cntHits;
+    unsigned long               cntMisses;
+    unsigned long               cntEvictions;
+    unsigned long               cntRecomputed;
+    TFncSet                     evictedFncs;
 
     void importGlVar(SymHeap &sh, const CVar &cv);
     void resolveHeapCut(TCVarList &cut, SymHeap &sh, TFncRef &fnc);
     SymCallCtx* getCallCtx(const SymHeap &entry, TFncRef fnc);
-
-    Private(TStorRef stor, bool ptrace):
-        bt(stor, ptrace)
+    void evict(ssize_t budget);
+
+    Private(TStorRef stor, bool ptrace, size_t budget_, bool summaries_):
+        bt(stor, ptrace),
+        budget(budget_),
+        summaries(summaries_),
+        clock(0UL),
+        cntHits(0UL),
+        cntMisses(0UL),
+        cntEvictions(0UL),
+        cntRecomputed(0UL)
     {
     }
 };
@@ -244,6 +315,42 @@ struct SymCallCtx::Private {
     }
 };
 
+ssize_t PerFncCache::cntBytes() const
+{
+    ssize_t cnt = 0;
+    BOOST_FOREACH(const SymHeap *sh, huni_)
+        cnt += estimateHeapBytes(*sh);
+
+    BOOST_FOREACH(const SymCallCtx *ctx, ctxMap_) {
+        if (!ctx || !ctx->d->computed)
+            continue;
+
+        BOOST_FOREACH(const SymHeap *sh, ctx->d->rawResults)
+            cnt += estimateHeapBytes(*sh);
+    }
+
+    return cnt;
+}
+
+int PerFncCache::lookupCovering(const SymHeap &sh)
+{
+    const int cnt = huni_.size();
+    for (int idx = 0; idx < cnt; ++idx) {
+        const SymCallCtx *ctx = ctxMap_[idx];
+        if (!ctx || ctx->inUse())
+            // no summary available for this entry yet
+            continue;
+
+        EJoinStatus status;
+        bool needJoin;
+        if (checkEntailment(&status, &needJoin, huni_[idx], sh))
+            // the given entry entails the cached one
+            return idx;
+    }
+
+    return -1;
+}
+
 SymCallCtx::SymCallCtx(SymCallCache::Private *cd):
     d(new Private(cd))
 {
@@ -251,6 +358,12 @@ SymCallCtx::SymCallCtx(SymCallCache::Private *cd):
 
 SymCallCtx::~SymCallCtx()
 {
+    if (d->computed) {
+        // the results are no longer cached
+        BOOST_FOREACH(const SymHeap *sh, d->rawResults)
+            memAccount(MS_CALL_CACHE, -1, -estimateHeapBytes(*sh));
+    }
+
     delete d;
 }
 
@@ -453,6 +566,12 @@ void SymCallCtx::flushCallResults(SymState &dst)
         dst.insert(sh);
     }
 
+    if (!d->computed) {
+        // the results are going to be cached from now on
+        BOOST_FOREACH(const SymHeap *sh, d->rawResults)
+            memAccount(MS_CALL_CACHE, 1, estimateHeapBytes(*sh));
+    }
+
     // mark as done
     d->computed = true;
     d->flushed = true;
@@ -495,9 +614,23 @@ void SymCallCtx::invalidate()
 
 // /////////////////////////////////////////////////////////////////////////////
 // implementation of SymCallCache
-SymCallCache::SymCallCache(TStorRef stor, bool ptrace):
-    d(new Private(stor, ptrace))
+SymCallCache::SymCallCache(
+        TStorRef                        stor,
+        bool                            ptrace,
+        size_t                          budget,
+        bool                            summaries):
+    d(new Private(stor, ptrace, budget, summaries))
 {
+    if (!summaries)
+        return;
+
+    int cntRecursive = 0;
+    BOOST_FOREACH(const CodeStorage::Fnc *fnc, stor.fncs)
+        if (fnc->cgNode && fnc->cgNode->recursive)
+            ++cntRecursive;
+
+    CL_DEBUG("SymCallCache: using function summaries, " << cntRecursive
+            << " recursive function(s)");
 }
 
 SymCallCache::~SymCallCache()
@@ -510,6 +643,74 @@ SymBackTrace& SymCallCache::bt()
     return d->bt;
 }
 
+struct EvictCandidate {
+    unsigned long   lastUse;
+    ssize_t         cntBytes;
+    int             uid;
+};
+
+/// the least recently used first, the bigger one first if used at the same time
+bool operator<(const EvictCandidate &a, const EvictCandidate &b)
+{
+    if (a.lastUse != b.lastUse)
+        return (a.lastUse < b.lastUse);
+
+    if (a.cntBytes != b.cntBytes)
+        return (b.cntBytes < a.cntBytes);
+
+    return (a.uid < b.uid);
+}
+
+void SymCallCache::Private::evict(const ssize_t budget)
+{
+    // collect the entries that are not in use by the current backtrace
+    std::vector<EvictCandidate> cands;
+    BOOST_FOREACH(TCache::const_reference item, this->cache) {
+        const PerFncCache &pfc = item.second;
+        if (pfc.inUse())
+            continue;
+
+        EvictCandidate cand;
+        cand.lastUse    = pfc.lastUse();
+        cand.cntBytes   = pfc.cntBytes();
+        cand.uid        = item.first;
+        cands.push_back(cand);
+    }
+
+    std::sort(cands.begin(), cands.end());
+
+    unsigned cntDropped = 0U;
+    BOOST_FOREACH(const EvictCandidate &cand, cands) {
+        if (memAccounted(MS_CALL_CACHE) <= budget)
+            break;
+
+        this->cache.erase(cand.uid);
+        this->evictedFncs.insert(cand.uid);
+        ++cntDropped;
+    }
+
+    if (!cntDropped)
+        return;
+
+    this->cntEvictions += cntDropped;
+    CL_DEBUG("SymCallCache evicted " << cntDropped
+            << " cached function(s), " << this->cache.size() << " kept");
+}
+
+void SymCallCache::trim()
+{
+    d->evict(/* drop all that we can */ 0);
+}
+
+void SymCallCache::printStats() const
+{
+    CL_DEBUG("SymCallCache: " << d->cntHits << " hit(s), "
+            << d->cntMisses << " miss(es), "
+            << d->cntEvictions << " eviction(s), "
+            << d->cntRecomputed << " miss(es) of evicted functions, "
+            << d->cache.size() << " function(s) cached");
+}
+
 void pullGlVar(SymHeap &result, SymHeap origin, const CVar &cv)
 {
     // do not try to combine things, it causes problems
@@ -711,9 +912,21 @@ SymCallCtx* SymCallCache::Private::getCallCtx(const SymHeap &entry, TFncRef fnc)
     // cache lookup
     const int uid = uidOf(fnc);
     PerFncCache &pfc = this->cache[uid];
+    pfc.touch(++this->clock);
+
+    const CodeStorage::CallGraph::Node *cgNode = fnc.cgNode;
+    if (this->summaries && cgNode && !cgNode->recursive)
+        // the results of a non-recursive fnc are complete once flushed
+        pfc.enableGeneralization();
+
     SymCallCtx *&ctx = pfc.lookup(entry);
     if (!ctx) {
         // cache miss
+        ++this->cntMisses;
+        if (hasKey(this->evictedFncs, uid))
+            // we had the results once, but they were evicted meanwhile
+            ++this->cntRecomputed;
+
         ctx = new SymCallCtx(this);
         ctx->d->fnc     = &fnc;
         ctx->d->entry   = entry;
@@ -742,6 +955,7 @@ SymCallCtx* SymCallCache::Private::getCallCtx(const SymHeap &entry, TFncRef fnc)
 
     // enter ctx stack
     this->ctxStack.push_back(ctx);
+    ++this->cntHits;
 
     // all OK, return the cached ctx
     return ctx;
@@ -752,6 +966,7 @@ SymCallCtx* SymCallCache::getCallCtx(
         const CodeStorage::Fnc          &fnc,
         const CodeStorage::Insn         &insn)
 {
+    ProfScope prof(PP_CALL_CACHE);
     const struct cl_loc *loc = &insn.loc;
     CL_DEBUG_MSG(loc, "SymCallCache is looking for " << nameOf(fnc) << "()...");
 
@@ -814,5 +1029,10 @@ SymCallCtx* SymCallCache::getCallCtx(
     Trace::waiveCloneOperation(ctx->d->callFrame);
     ctx->d->entry.traceUpdate(trEntry);
 
+    const ssize_t budget = d->budget;
+    if (budget && budget < memAccounted(MS_CALL_CACHE))
+        // the just returned ctx is in use now, so it cannot be evicted
+        d->evict(budget);
+
     return ctx;
 }
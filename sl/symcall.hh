@@ -40,8 +40,20 @@ namespace CodeStorage {
 /// persistent cache for results of fncs called during the symbolic execution
 class SymCallCache {
     public:
-        /// create long term cache, this should happen once per SymExec lifetime
-        SymCallCache(TStorRef stor, bool ptrace);
+        /**
+         * create long term cache, this should happen once per SymExec lifetime
+         * @param budget if not zero, the least recently used entries that are
+         * not in use by the current backtrace are evicted from the cache as
+         * soon as the estimated size of the cache exceeds this many bytes
+         * @param summaries if true, the results computed for an entry heap are
+         * reused for all entry heaps that the entry heap covers (the recursive
+         * functions, as given by the SCCs of the call graph, are excluded)
+         */
+        SymCallCache(
+                TStorRef                    stor,
+                bool                        ptrace,
+                size_t                      budget = 0U,
+                bool                        summaries = false);
         ~SymCallCache();
 
         SymBackTrace& bt();
@@ -61,6 +73,15 @@ class SymCallCache {
                 const CodeStorage::Fnc       &fnc,
                 const CodeStorage::Insn      &insn);
 
+        /**
+         * release the cached results of all functions that are not being used
+         * by the current backtrace, invoked if the memory budget is exceeded
+         */
+        void trim();
+
+        /// print statistics about cache hits, misses, and evictions
+        void printStats() const;
+
     private:
         /// object copying is @b not allowed
         SymCallCache(const SymCallCache &);
@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "symcapture.hh"
+
+#include <cl/cl_msg.hh>
+
+#include "symabstract.hh"
+#include "symcmp.hh"
+#include "symcut.hh"
+#include "symjoin.hh"
+#include "symserial.hh"
+#include "symtrace.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#include <time.h>
+
+#include <boost/foreach.hpp>
+
+/// magic bytes at the beginning of a file with captured operations
+static const char captureFileMagic[] = "SLCAPTURE";
+
+/// version of the format, bump on any incompatible change of the layout
+#define SYMCAPTURE_VERSION 2
+
+static const char *opNames[] = {
+    "join",
+    "areEqual",
+    "abstract",
+    "split"
+};
+
+typedef unsigned long long TNsec;
+
+static TNsec now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<TNsec>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+struct CapturedOp {
+    ECaptureOp                  op;
+    unsigned                    flags;
+    int                         outcome;
+    std::vector<std::string>    heaps;      ///< serialized input heaps
+    TCVarList                   cut;
+
+    CapturedOp():
+        op(CO_LAST),
+        flags(0U),
+        outcome(-1)
+    {
+    }
+};
+
+static void writeOp(std::string &dst, const CapturedOp &co)
+{
+    ByteWriter w(dst);
+    w.putUInt(co.op);
+    w.putUInt(co.flags);
+    w.putInt(co.outcome);
+
+    w.putUInt(co.heaps.size());
+    BOOST_FOREACH(const std::string &blob, co.heaps)
+        w.putStr(blob);
+
+    w.putUInt(co.cut.size());
+    BOOST_FOREACH(const CVar &cv, co.cut) {
+        w.putInt(cv.uid);
+        w.putInt(cv.inst);
+    }
+}
+
+static bool readOp(CapturedOp *pDst, ByteReader &r)
+{
+    const unsigned long long op = r.getUInt();
+    if (CO_LAST <= op)
+        return false;
+
+    pDst->op        = static_cast<ECaptureOp>(op);
+    pDst->flags     = r.getUInt();
+    pDst->outcome   = r.getInt();
+
+    for (unsigned long long cnt = r.getUInt(); r.ok() && cnt; --cnt)
+        pDst->heaps.push_back(r.getStr());
+
+    for (unsigned long long cnt = r.getUInt(); r.ok() && cnt; --cnt) {
+        const int uid  = r.getInt();
+        const int inst = r.getInt();
+        pDst->cut.push_back(CVar(uid, inst));
+    }
+
+    return r.ok();
+}
+
+int captureOutcomeOf(const SymHeap &sh)
+{
+    // the count of objects does not depend on IDs of the reloaded heaps
+    TValList roots;
+    sh.gatherRootObjects(roots, isPossibleToDeref);
+    return roots.size();
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// capture
+struct CaptureData {
+    std::string                 fileName;
+    std::fstream                out;
+    bool                        headerWritten;
+    unsigned                    depth;
+    unsigned long long          cntOps[CO_LAST];
+
+    CaptureData():
+        headerWritten(false),
+        depth(0U)
+    {
+        std::fill(cntOps, cntOps + CO_LAST, 0ULL);
+    }
+};
+
+static CaptureData *capture;
+
+bool HeapCapture::enabled_;
+
+void HeapCapture::enable(const std::string &fileName)
+{
+    if (!::capture)
+        ::capture = new CaptureData;
+
+    ::capture->fileName = fileName;
+    ::capture->out.open(fileName.c_str(),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!::capture->out) {
+        CL_ERROR("unable to create file '" << fileName << "'");
+        return;
+    }
+
+    enabled_ = true;
+}
+
+bool HeapCapture::flush()
+{
+    if (!enabled_)
+        return false;
+
+    enabled_ = false;
+    CaptureData &cd = *::capture;
+    cd.out.close();
+    if (!cd.out) {
+        CL_ERROR("error while writing file '" << cd.fileName << "'");
+        return false;
+    }
+
+    for (int i = 0; i < CO_LAST; ++i) {
+        if (cd.cntOps[i])
+            CL_NOTE("capture: " << std::setw(12) << opNames[i]
+                    << std::setw(12) << cd.cntOps[i] << " op(s) captured");
+    }
+
+    CL_NOTE("capture: written to '" << cd.fileName << "'");
+    return true;
+}
+
+CaptureScope::CaptureScope(
+        const ECaptureOp            op,
+        const SymHeap              &sh1,
+        const SymHeap              *sh2,
+        const unsigned              flags,
+        const TCVarList            *cut):
+    counted_(HeapCapture::enabled()),
+    op_(0)
+{
+    if (!counted_ || (::capture->depth++))
+        // disabled, or nested in another captured operation
+        return;
+
+    CaptureData &cd = *::capture;
+    if (!cd.headerWritten) {
+        std::string hdr;
+        writeFileHeader(hdr, captureFileMagic, SYMCAPTURE_VERSION, sh1.stor());
+        cd.out << hdr;
+        cd.headerWritten = true;
+    }
+
+    op_ = new CapturedOp;
+    op_->op = op;
+    op_->flags = flags;
+    if (cut)
+        op_->cut = *cut;
+
+    op_->heaps.push_back(std::string());
+    serializeHeap(op_->heaps.back(), sh1);
+    if (!sh2)
+        return;
+
+    op_->heaps.push_back(std::string());
+    serializeHeap(op_->heaps.back(), *sh2);
+}
+
+void CaptureScope::setOutcome(const int outcome)
+{
+    if (op_)
+        op_->outcome = outcome;
+}
+
+CaptureScope::~CaptureScope()
+{
+    if (!counted_)
+        return;
+
+    CaptureData &cd = *::capture;
+    --cd.depth;
+    if (!op_ || !HeapCapture::enabled()) {
+        delete op_;
+        return;
+    }
+
+    std::string buf;
+    writeOp(buf, *op_);
+    ++cd.cntOps[op_->op];
+    delete op_;
+
+    cd.out << buf;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// replay
+static int replayOp(const CapturedOp &co, const SymHeap *heaps[2])
+{
+    TStorRef stor = heaps[0]->stor();
+
+    switch (co.op) {
+        case CO_JOIN: {
+            EJoinStatus status;
+            SymHeap dst(stor, new Trace::TransientNode("replayOp()"));
+            const bool allowThreeWay    = (co.flags & 0x1);
+            const bool widen            = (co.flags & 0x2);
+            if (!joinSymHeaps(&status, &dst, *heaps[0], *heaps[1],
+                        allowThreeWay, widen))
+                return -1;
+
+            return status;
+        }
+
+        case CO_ARE_EQUAL:
+            return areEqual(*heaps[0], *heaps[1]);
+
+        case CO_ABSTRACT: {
+            SymHeap sh(*heaps[0]);
+            abstractIfNeeded(sh);
+            return captureOutcomeOf(sh);
+        }
+
+        case CO_SPLIT: {
+            SymHeap sh(*heaps[0]);
+            SymHeap frame(stor, new Trace::TransientNode("replayOp()"));
+            splitHeapByCVars(&sh, co.cut, (co.flags) ? &frame : 0);
+            return captureOutcomeOf(sh);
+        }
+
+        case CO_LAST:
+            break;
+    }
+
+    CL_BREAK_IF("replayOp() got an invalid operation");
+    return -1;
+}
+
+static TNsec percentile(const std::vector<TNsec> &sorted, const unsigned pct)
+{
+    const size_t idx = sorted.size() * pct / 100U;
+    return sorted[std::min(idx, sorted.size() - 1U)];
+}
+
+static void printLatencies(const char *name, std::vector<TNsec> &samples)
+{
+    if (samples.empty())
+        return;
+
+    std::sort(samples.begin(), samples.end());
+
+    TNsec total = 0ULL;
+    BOOST_FOREACH(const TNsec ns, samples)
+        total += ns;
+
+    CL_NOTE("replay: " << std::setw(12) << name
+            << std::setw(12) << samples.size() << " run(s), usec:"
+            << std::fixed << std::setprecision(1)
+            << " min "  << (samples.front()              / 1000.0)
+            << ", p50 " << (percentile(samples, 50U)     / 1000.0)
+            << ", p90 " << (percentile(samples, 90U)     / 1000.0)
+            << ", p99 " << (percentile(samples, 99U)     / 1000.0)
+            << ", max " << (samples.back()               / 1000.0)
+            << ", total " << (total                      / 1000.0));
+}
+
+bool replayCapturedOps(
+        TStorRef                    stor,
+        const std::string          &fileName,
+        const unsigned              rounds)
+{
+    std::fstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!in) {
+        CL_ERROR("unable to open file '" << fileName << "'");
+        return false;
+    }
+
+    std::string buf((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+
+    if (!buf.empty() && !stripFileHeader(buf, captureFileMagic,
+                SYMCAPTURE_VERSION, stor))
+    {
+        CL_ERROR("'" << fileName << "' does not contain operations "
+                "captured against this code storage");
+        return false;
+    }
+
+    std::vector<TNsec> samples[CO_LAST];
+    unsigned long long cntMismatch = 0ULL;
+
+    ByteReader r(buf);
+    while (!r.atEnd()) {
+        CapturedOp co;
+        if (!readOp(&co, r))
+            break;
+
+        const unsigned cntHeaps = (CO_JOIN == co.op || CO_ARE_EQUAL == co.op)
+            ? 2U
+            : 1U;
+
+        if (co.heaps.size() != cntHeaps) {
+            CL_ERROR("'" << fileName << "' contains a malformed record");
+            return false;
+        }
+
+        // reload the input heaps (not accounted to the operation)
+        std::vector<SymHeap> loaded;
+        BOOST_FOREACH(const std::string &blob, co.heaps) {
+            loaded.push_back(SymHeap(stor,
+                        new Trace::TransientNode("replayCapturedOps()")));
+
+            if (!deserializeHeap(loaded.back(), blob))
+                return false;
+        }
+
+        const SymHeap *heaps[2] = { &loaded[0], &loaded[cntHeaps - 1U] };
+
+        for (unsigned i = 0U; i < rounds; ++i) {
+            const TNsec start = now();
+            const int outcome = replayOp(co, heaps);
+            samples[co.op].push_back(now() - start);
+
+            if (!i && outcome != co.outcome)
+                ++cntMismatch;
+        }
+    }
+
+    if (!r.ok()) {
+        CL_ERROR("'" << fileName << "' is truncated");
+        return false;
+    }
+
+    for (int i = 0; i < CO_LAST; ++i)
+        printLatencies(opNames[i], samples[i]);
+
+    if (cntMismatch)
+        CL_WARN("replay: " << cntMismatch << " operation(s) did not give "
+                "the captured outcome");
+
+    return true;
+}
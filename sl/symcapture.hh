@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_SYMCAPTURE_H
+#define H_GUARD_SYMCAPTURE_H
+
+/**
+ * @file symcapture.hh
+ * capture of the input heaps of joinSymHeaps(), areEqual(), abstractIfNeeded()
+ * and splitHeapByCVars() on real inputs (enabled by the @b capture:FILE
+ * plug-in argument), and their offline replay (the @b replay:FILE plug-in
+ * argument, see slbench), which reports latency distributions of the
+ * operations measured in isolation.
+ *
+ * The captured heaps are bound to the code storage they come from, so the
+ * replay needs to run on the same source code as the capture did.  Only the
+ * outermost captured operation is recorded, e.g. areEqual() called from within
+ * joinSymHeaps() is not recorded separately.
+ */
+
+#include "symheap.hh"
+
+#include <string>
+
+/// operations on symbolic heaps that can be captured and replayed
+enum ECaptureOp {
+    CO_JOIN = 0,            ///< joinSymHeaps()
+    CO_ARE_EQUAL,           ///< areEqual()
+    CO_ABSTRACT,            ///< abstractIfNeeded()
+    CO_SPLIT,               ///< splitHeapByCVars()
+    CO_LAST                 ///< just a sentinel, not a real operation
+};
+
+class HeapCapture {
+    public:
+        /// enable the capture, the records are written to the given file
+        static void enable(const std::string &fileName);
+
+        /// true if the capture is enabled, the check is supposed to be cheap
+        static bool enabled() {
+            return enabled_;
+        }
+
+        /// write the pending records to the file and stop the capture
+        static bool flush();
+
+    private:
+        /// library class
+        HeapCapture();
+
+        static bool enabled_;
+};
+
+struct CapturedOp;
+
+/// RAII helper recording a single operation (does nothing if disabled)
+class CaptureScope {
+    public:
+        /**
+         * serialize the input of the operation
+         * @param op the operation being captured
+         * @param sh1 the (first) input heap of the operation
+         * @param sh2 the second input heap (binary operations only)
+         * @param flags allowThreeWay | (widen << 1) of joinSymHeaps(),
+         * saveFrameTo != 0 for splitHeapByCVars(), zero otherwise
+         * @param cut the list of variables of splitHeapByCVars()
+         */
+        CaptureScope(
+                ECaptureOp              op,
+                const SymHeap          &sh1,
+                const SymHeap          *sh2     = 0,
+                unsigned                flags   = 0U,
+                const TCVarList        *cut     = 0);
+
+        /// write the record with the outcome set by setOutcome()
+        ~CaptureScope();
+
+        /// true if this operation is going to be recorded
+        bool active() const {
+            return !!op_;
+        }
+
+        /// set the outcome of the operation, checked on replay
+        void setOutcome(int outcome);
+
+    private:
+        // not implemented
+        CaptureScope(const CaptureScope &);
+        CaptureScope& operator=(const CaptureScope &);
+
+        const bool          counted_;   ///< true if the capture is enabled
+        CapturedOp         *op_;        ///< 0 if not recorded
+};
+
+/// outcome of abstractIfNeeded() and splitHeapByCVars() used by CaptureScope
+int captureOutcomeOf(const SymHeap &sh);
+
+/**
+ * replay the operations captured in the given file and print latency
+ * distributions of each type of operation
+ * @param stor the code storage the heaps were captured against
+ * @param fileName name of the file written by HeapCapture
+ * @param rounds how many times each of the operations is repeated
+ * @return true on success, false if the file could not be loaded
+ */
+bool replayCapturedOps(
+        TStorRef                    stor,
+        const std::string          &fileName,
+        unsigned                    rounds);
+
+#endif /* H_GUARD_SYMCAPTURE_H */
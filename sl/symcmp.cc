@@ -22,6 +22,8 @@
 
 #include <cl/cl_msg.hh>
 
+#include "profiler.hh"
+#include "symcapture.hh"
 #include "symseg.hh"
 #include "symutil.hh"
 #include "util.hh"
@@ -240,7 +242,7 @@ bool cmpValues(
 }
 
 typedef std::queue<TValPair>                        TSched;
-typedef WorkList<TValPair,TSched>                   TWorkList;
+typedef WorkList<TValPair, TSched, FlatSet<TValPair> >  TWorkList;
 
 class ValueComparator {
     private:
@@ -334,7 +336,56 @@ class VarScheduleVisitor {
         }
 };
 
-bool areEqual(
+/// worklists reused across calls of areEqualCore(), one per nesting level
+class WorkListPool {
+    public:
+        WorkListPool():
+            depth_(0U)
+        {
+        }
+
+        ~WorkListPool() {
+            BOOST_FOREACH(TWorkList *wl, pool_)
+                delete wl;
+        }
+
+        TWorkList& acquire() {
+            if (pool_.size() == depth_)
+                pool_.push_back(new TWorkList);
+
+            TWorkList &wl = *pool_[depth_++];
+            wl.clear();
+            return wl;
+        }
+
+        void release() {
+            CL_BREAK_IF(!depth_);
+            --depth_;
+        }
+
+    private:
+        std::vector<TWorkList *>    pool_;
+        unsigned                    depth_;
+};
+
+static WorkListPool wlPool;
+
+/// borrow a worklist from wlPool for the scope of a single areEqualCore() call
+class PooledWorkList {
+    public:
+        PooledWorkList():
+            wl(::wlPool.acquire())
+        {
+        }
+
+        ~PooledWorkList() {
+            ::wlPool.release();
+        }
+
+        TWorkList &wl;
+};
+
+static bool areEqualCore(
         const SymHeap           &sh1,
         const SymHeap           &sh2)
 {
@@ -346,7 +397,10 @@ bool areEqual(
         &sh2Writable
     };
 
-    TWorkList wl;
+    // reuse the storage allocated by previous calls of areEqual()
+    PooledWorkList pooled;
+    TWorkList &wl = pooled.wl;
+
     if (sh1.valLastKnownTypeOfTarget(VAL_ADDR_OF_RET)
             || sh2.valLastKnownTypeOfTarget(VAL_ADDR_OF_RET))
     {
@@ -369,3 +423,15 @@ bool areEqual(
     return sh1.matchPreds(sh2, vMap[0])
         && sh2.matchPreds(sh1, vMap[1]);
 }
+
+bool areEqual(
+        const SymHeap           &sh1,
+        const SymHeap           &sh2)
+{
+    ProfScope prof(PP_ARE_EQUAL);
+    CaptureScope cap(CO_ARE_EQUAL, sh1, &sh2);
+
+    const bool eq = areEqualCore(sh1, sh2);
+    cap.setOutcome(eq);
+    return eq;
+}
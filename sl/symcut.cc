@@ -25,6 +25,8 @@
 #include <cl/code_listener.h>
 #include <cl/storage.hh>
 
+#include "profiler.hh"
+#include "symcapture.hh"
 #include "symplot.hh"
 #include "symseg.hh"
 #include "symutil.hh"
@@ -366,6 +368,8 @@ void splitHeapByCVars(
 #if SE_DISABLE_SYMCUT
     return;
 #endif
+    ProfScope prof(PP_SYMCUT);
+    CaptureScope cap(CO_SPLIT, *srcDst, /* sh2 */ 0, !!saveFrameTo, &cut);
 
 #if DEBUG_SYMCUT
     CL_DEBUG("splitHeapByCVars() started: cut by " << cut.size() << " variable(s)");
@@ -387,6 +391,8 @@ void splitHeapByCVars(
 #endif
     SymHeap dst(srcDst->stor(), new Trace::TransientNode("splitHeapByCVars()"));
     prune(*srcDst, dst, cset);
+    if (cap.active())
+        cap.setOutcome(captureOutcomeOf(dst));
 
     if (!saveFrameTo) {
         // we're done
@@ -450,6 +456,7 @@ void joinHeapsByCVars(
 #if SE_DISABLE_SYMCUT
     return;
 #endif
+    ProfScope prof(PP_SYMCUT);
     // gather _all_ program variables of *src2
     DeepCopyData::TCut cset;
     gatherProgramVars(cset, *src2);
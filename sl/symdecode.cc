@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "symdecode.hh"
+
+#include <cl/cl_msg.hh>
+#include <cl/clutil.hh>
+#include <cl/storage.hh>
+
+#include <functional>
+
+#include <boost/foreach.hpp>
+
+const DecodedOperand* DecodedInsn::operandOf(const struct cl_operand &op) const
+{
+    const CodeStorage::TOperandList &opList = insn->operands;
+    if (opList.empty())
+        return 0;
+
+    // the operand may come from elsewhere, e.g. an array index or initializer
+    std::less<const struct cl_operand *> lt;
+    const struct cl_operand *beg = &opList.front();
+    if (lt(&op, beg) || !lt(&op, beg + opList.size()))
+        return 0;
+
+    const DecodedOperand &dop = operands[&op - beg];
+    return (dop.fast) ? &dop : 0;
+}
+
+/// mirror of SymProc::targetAt() for the parts that do not depend on the heap
+static void decodeOperand(DecodedOperand *pDst, const struct cl_operand &op)
+{
+    if (CL_OPERAND_VAR != op.code)
+        // literals are not resolved by SymProc::targetAt()
+        return;
+
+    pDst->uid = varIdFromOperand(&op);
+
+    const struct cl_accessor *ac = op.accessor;
+    pDst->hasAccessor = !!ac;
+    if (ac && CL_ACCESSOR_DEREF == ac->code) {
+        pDst->isDeref = true;
+        ac = ac->next;
+    }
+
+    TOffset off = 0;
+    for (; ac; ac = ac->next) {
+        const enum cl_accessor_e code = ac->code;
+        switch (code) {
+            case CL_ACCESSOR_REF:
+                continue;
+
+            case CL_ACCESSOR_DEREF:
+            case CL_ACCESSOR_DEREF_ARRAY:
+                // the offset depends on the heap, leave it for the slow path
+                return;
+
+            case CL_ACCESSOR_ITEM: {
+                const int id = ac->data.item.id;
+                const TObjType clt = ac->type;
+                CL_BREAK_IF(!clt || clt->item_cnt <= id);
+                off += clt->items[id].offset;
+                continue;
+            }
+
+            case CL_ACCESSOR_OFFSET:
+                off += ac->data.offset.off;
+                continue;
+        }
+    }
+
+    pDst->off = off;
+    pDst->fast = true;
+}
+
+/// operands of insn which may need concretization, mirror of SymExecCore::exec()
+static void decodeDerefs(DecodedInsn *pDst)
+{
+    const CodeStorage::Insn &insn = *pDst->insn;
+    TOpIdxList &derefs = pDst->derefs;
+
+    if (CL_INSN_CALL == insn.code) {
+        pDst->staticCallee = resolveBuiltIn(&pDst->builtIn,
+                &pDst->builtInName, insn);
+
+        if (!pDst->staticCallee)
+            // derefs of an indirect call depend on the heap
+            return;
+
+        if (pDst->builtIn)
+            // certain built-ins dereference certain operands (free, ...)
+            derefs = opsWithDerefSemantics(*pDst->builtIn);
+    }
+
+    const CodeStorage::TOperandList &opList = insn.operands;
+    for (unsigned idx = 0; idx < opList.size(); ++idx) {
+        const struct cl_accessor *ac = opList[idx].accessor;
+        if (!ac)
+            continue;
+
+        const enum cl_accessor_e code = ac->code;
+        if (CL_ACCESSOR_DEREF != code && CL_ACCESSOR_DEREF_ARRAY != code)
+            continue;
+
+        if (seekRefAccessor(ac))
+            // not a dereference, only an address is being computed
+            continue;
+
+        derefs.push_back(idx);
+    }
+
+    pDst->derefsKnown = true;
+}
+
+static void decodeInsn(DecodedInsn *pDst, const CodeStorage::Insn &insn)
+{
+    pDst->insn = &insn;
+    if (cl_is_term_insn(insn.code))
+        // terminal instructions are executed by SymExecEngine directly
+        return;
+
+    const CodeStorage::TOperandList &opList = insn.operands;
+    pDst->operands.resize(opList.size());
+    for (unsigned idx = 0; idx < opList.size(); ++idx)
+        decodeOperand(&pDst->operands[idx], opList[idx]);
+
+    decodeDerefs(pDst);
+}
+
+const TDecodedFnc& FncDecoder::decode(const CodeStorage::Fnc &fnc)
+{
+    TCache::iterator it = cache_.find(&fnc);
+    if (cache_.end() != it)
+        return it->second;
+
+    TDecodedFnc &dst = cache_[&fnc];
+    BOOST_FOREACH(const CodeStorage::Block *bb, fnc.cfg) {
+        TDecodedBlock &dBlock = dst[bb];
+        dBlock.resize(bb->size());
+        for (unsigned idx = 0; idx < bb->size(); ++idx)
+            decodeInsn(&dBlock[idx], *bb->operator[](idx));
+    }
+
+    CL_DEBUG("FncDecoder::decode() decoded " << dst.size() << " block(s) of "
+            << nameOf(fnc) << "()");
+
+    return dst;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_SYMDECODE_H
+#define H_GUARD_SYMDECODE_H
+
+/**
+ * @file symdecode.hh
+ * one-time lowering of CodeStorage::Fnc into a pre-decoded form consumed by
+ * SymExecCore, so that the things which do not depend on the heap (accessor
+ * chains, constant offsets, built-in look-up, operands to concretize) are not
+ * recomputed for each heap reaching an instruction
+ */
+
+#include "symbin.hh"                // for TOpIdxList
+#include "symheap.hh"               // for TOffset
+
+#include <map>
+#include <vector>
+
+namespace CodeStorage {
+    class Block;
+    struct Fnc;
+    struct Insn;
+}
+
+/// pre-decoded operand, as needed by SymProc::targetAt()
+struct DecodedOperand {
+    bool                            fast;       ///< false to use the slow path
+    int                             uid;        ///< uid of the variable
+    bool                            hasAccessor;///< false for a plain variable
+    bool                            isDeref;    ///< read the pointer first
+    TOffset                         off;        ///< sum of constant offsets
+
+    DecodedOperand():
+        fast(false),
+        uid(-1),
+        hasAccessor(false),
+        isDeref(false),
+        off(0)
+    {
+    }
+};
+
+/// pre-decoded non-terminal instruction
+struct DecodedInsn {
+    const CodeStorage::Insn         *insn;
+    std::vector<DecodedOperand>     operands;
+
+    /// operands to concretize, valid only if derefsKnown is true
+    TOpIdxList                      derefs;
+    bool                            derefsKnown;
+
+    /// true if the callee of a @b call instruction is known statically
+    bool                            staticCallee;
+
+    /// the built-in being called, 0 if the callee is not a built-in
+    const BuiltIn                   *builtIn;
+    const char                      *builtInName;
+
+    DecodedInsn():
+        insn(0),
+        derefsKnown(false),
+        staticCallee(false),
+        builtIn(0),
+        builtInName(0)
+    {
+    }
+
+    /// return the pre-decoded form of op if it belongs to insn, 0 otherwise
+    const DecodedOperand* operandOf(const struct cl_operand &op) const;
+};
+
+/// pre-decoded instructions of a basic block, indexed as in the block
+typedef std::vector<DecodedInsn>                                TDecodedBlock;
+
+/// pre-decoded basic blocks of a function
+typedef std::map<const CodeStorage::Block *, TDecodedBlock>     TDecodedFnc;
+
+/// pre-decoded functions, owned by SymExec for the run of the analysis
+class FncDecoder {
+    public:
+        /**
+         * decode all instructions of the given function, the result is cached
+         * as long as the decoder lives, so the lowering runs only once per
+         * function
+         */
+        const TDecodedFnc& decode(const CodeStorage::Fnc &fnc);
+
+    private:
+        typedef std::map<const CodeStorage::Fnc *, TDecodedFnc> TCache;
+        TCache                      cache_;
+};
+
+#endif /* H_GUARD_SYMDECODE_H */
@@ -26,10 +26,12 @@
 #include <cl/clutil.hh>
 
 #include "memdebug.hh"
+#include "profiler.hh"
 #include "sigcatch.hh"
 #include "symabstract.hh"
 #include "symcall.hh"
 #include "symdebug.hh"
+#include "symdecode.hh"
 #include "sympath.hh"
 #include "symproc.hh"
 #include "symstate.hh"
@@ -54,6 +56,13 @@ bool installSignalHandlers(void)
         && SignalCatcher::install(SIGTERM);
 }
 
+/// true if the estimated size of all SymStateMap objects exceeds spill_budget
+static bool spillBudgetExceeded(const SymExecParams &ep)
+{
+    return ep.spillBudget
+        && static_cast<ssize_t>(ep.spillBudget) < memAccounted(MS_STATE_MAP);
+}
+
 // /////////////////////////////////////////////////////////////////////////////
 // ExecStack
 class SymExecEngine;
@@ -73,7 +82,7 @@ class SymExec: public IStatsProvider {
         SymExec(const CodeStorage::Storage &stor, const SymExecParams &ep):
             stor_(stor),
             params_(ep),
-            callCache_(stor, ep.ptrace)
+            callCache_(stor, ep.ptrace, ep.callCacheBudget, ep.fncSummaries)
         {
         }
 
@@ -99,6 +108,7 @@ class SymExec: public IStatsProvider {
         const CodeStorage::Storage              &stor_;
         SymExecParams                           params_;
         SymCallCache                            callCache_;
+        FncDecoder                              decoder_;
         TExecStack                              execStack_;
 };
 
@@ -111,14 +121,18 @@ class SymExecEngine: public IStatsProvider {
                 const SymHeap           &entry,
                 const IStatsProvider    &stats,
                 const SymExecParams     &ep,
-                SymBackTrace            &bt):
+                SymBackTrace            &bt,
+                FncDecoder              &decoder):
             stor_(entry.stor()),
             params_(ep),
             bt_(bt),
             dst_(results),
             stats_(stats),
+            decoder_(decoder),
             ptracer_(stateMap_),
             sched_(stateMap_),
+            decFnc_(0),
+            decBlock_(0),
             block_(0),
             insnIdx_(0),
             heapIdx_(0),
@@ -148,17 +162,23 @@ class SymExecEngine: public IStatsProvider {
         bool                            endReached() const;
         void                            forceEndReached();
 
+        /// move states of the blocks not scheduled for processing out of memory
+        void                            spillIdleStates();
+
     private:
         const CodeStorage::Storage      &stor_;
         SymExecParams                   params_;
         SymBackTrace                    &bt_;
         SymState                        &dst_;
         const IStatsProvider            &stats_;
+        FncDecoder                      &decoder_;
         std::string                     fncName_;
 
         SymStateMap                     stateMap_;
         PathTracer                      ptracer_;
         BlockScheduler                  sched_;
+        const TDecodedFnc               *decFnc_;
+        const TDecodedBlock             *decBlock_;
         const CodeStorage::Block        *block_;
         unsigned                        insnIdx_;
         unsigned                        heapIdx_;
@@ -217,6 +237,9 @@ void SymExecEngine::initEngine(const SymHeap &init)
     lw_ = locationOf(fnc);
     CL_DEBUG_MSG(lw_, ">>> entering " << fncName_ << "()");
 
+    // lower the function (done only once per function)
+    decFnc_ = &decoder_.decode(fnc);
+
     // look for the entry block
     const CodeStorage::Block *entry = fnc.cfg.entry();
     if (!entry) {
@@ -555,8 +578,6 @@ void SymExecEngine::execTermInsn()
 
 bool /* handled */ SymExecEngine::execNontermInsn()
 {
-    const CodeStorage::Insn *insn = block_->operator[](insnIdx_);
-
     // set some properties of the execution
     SymExecCoreParams ep;
     ep.trackUninit      = params_.trackUninit;
@@ -574,8 +595,10 @@ bool /* handled */ SymExecEngine::execNontermInsn()
     Trace::waiveCloneOperation(sh);
 
     // execute the instruction
-    if (!core.exec(nextLocalState_, *insn)) {
-        CL_BREAK_IF(CL_INSN_CALL != insn->code);
+    const DecodedInsn &dec = decBlock_->operator[](insnIdx_);
+    CL_BREAK_IF(dec.insn != block_->operator[](insnIdx_));
+    if (!core.exec(nextLocalState_, dec)) {
+        CL_BREAK_IF(CL_INSN_CALL != dec.insn->code);
         return false;
     }
 
@@ -644,6 +667,8 @@ bool /* complete */ SymExecEngine::execInsn()
         // time to respond to a single pending signal
         this->processPendingSignals();
 
+        ProfScope prof(PP_EXEC_INSN, insn->code);
+
         if (isTerm) {
             // terminal insn
             this->execTermInsn();
@@ -759,6 +784,7 @@ bool /* complete */ SymExecEngine::run()
         this->joinCallResults();
 
         // we're on the way from a just completed function call...
+        ProfBlockScope prof(block_->name());
         if (!this->execBlock())
             // ... and we've just hit another one
             return false;
@@ -773,6 +799,14 @@ bool /* complete */ SymExecEngine::run()
 
     // main loop of SymExecEngine
     while (sched_.getNext(&block_)) {
+        if (spillBudgetExceeded(params_))
+            this->spillIdleStates();
+
+        // look for the pre-decoded instructions of the block
+        const TDecodedFnc::const_iterator it = decFnc_->find(block_);
+        CL_BREAK_IF(decFnc_->end() == it);
+        decBlock_ = &it->second;
+
         // update location info and ptracer
         const CodeStorage::Insn *first = block_->front();
         lw_ = &first->loc;
@@ -787,6 +821,7 @@ bool /* complete */ SymExecEngine::run()
         heapIdx_ = 0;
 
         // process the basic block till the first function call
+        ProfBlockScope prof(name);
         if (!this->execBlock())
             // function call reached, suspend the execution for now
             return false;
@@ -917,6 +952,7 @@ void SymExecEngine::processPendingSignals()
     CL_WARN_MSG(lw_, "caught signal " << signum);
     stats_.printStats();
     printMemUsage("SymExec::printStats");
+    printMemAccounting();
 
     switch (signum) {
         case SIGUSR1:
@@ -928,43 +964,53 @@ void SymExecEngine::processPendingSignals()
     }
 }
 
+void SymExecEngine::spillIdleStates()
+{
+    SymStateMap::TBlockSet keep(sched_.todo());
+    if (block_)
+        keep.insert(block_);
+
+    const unsigned cnt = stateMap_.spillIdleStates(params_.spillBudget, keep);
+    if (!cnt)
+        return;
+
+    CL_DEBUG("SymExecEngine::spillIdleStates() spilled states of "
+            << cnt << " block(s) of " << fncName_ << "()");
+
+    printMemUsage("SymExecEngine::spillIdleStates");
+}
+
 void SymExecEngine::pruneOrigin()
 {
-#if SE_STATE_PRUNING_MODE
     if (block_->isLoopEntry())
-#endif
         // never prune loop entry, it would break the fixed-point computation
         return;
 
     SymStateMarked &origin = stateMap_[block_];
     const unsigned size = origin.size();
 
+    if (block_->isStateRetained()) {
+        // heaps coming along different paths meet here, see findRetainedStates()
+        if (memBudgetExceeded(params_.memBudget)) {
+            CL_DEBUG_MSG(lw_, "memory budget exceeded, pruning "
+                    << block_->name());
+            goto thr_reached;
+        }
+
 #if SE_STATE_PRUNING_MISS_THR
-    if (!stateMap_.anyReuseHappened(block_)
-            && (SE_STATE_PRUNING_MISS_THR) <= size)
-        goto thr_reached;
+        if (!stateMap_.anyReuseHappened(block_)
+                && (SE_STATE_PRUNING_MISS_THR) <= size)
+            goto thr_reached;
 #endif
 
 #if SE_STATE_PRUNING_TOTAL_THR
-    if ((SE_STATE_PRUNING_TOTAL_THR) <= size)
-        goto thr_reached;
+        if ((SE_STATE_PRUNING_TOTAL_THR) <= size)
+            goto thr_reached;
 #endif
-
-#if SE_STATE_PRUNING_MODE < 2
-    if (!cl_is_term_insn(block_->front()->code)
-            && (CL_INSN_COND != block_->back()->code || 2 < block_->size()))
         return;
-#endif
-
-#if SE_STATE_PRUNING_MODE < 3
-    if (1 < block_->inbound().size())
-        // more than one incoming edges, keep this one
-        return;
-#endif
+    }
 
-#if SE_STATE_PRUNING_MISS_THR || SE_STATE_PRUNING_TOTAL_THR
 thr_reached:
-#endif
     if (0x100 < size)
         printMemUsage("SymExecEngine::execInsn");
 
@@ -1002,7 +1048,12 @@ SymExec::~SymExec()
         // delete engine
         delete item.eng;
         printMemUsage("SymExecEngine::~SymExecEngine");
+
+        if (Profiler::enabled())
+            Profiler::popFrame();
     }
+
+    callCache_.printStats();
 }
 
 const CodeStorage::Fnc* SymExec::resolveCallInsn(
@@ -1085,7 +1136,8 @@ void SymExec::enterCall(SymCallCtx *ctx, SymState &results)
             ctx->entry(),
             /* IStatsProvider */ *this,
             params_,
-            callCache_.bt());
+            callCache_.bt(),
+            decoder_);
 
     // initialize a stack item
     ExecStackItem item;
@@ -1096,6 +1148,11 @@ void SymExec::enterCall(SymCallCtx *ctx, SymState &results)
     // push the item to the exec-stack
     execStack_.push_front(item);
     printMemUsage("SymExec::enterCall");
+
+    if (Profiler::enabled()) {
+        const CodeStorage::Fnc *fnc = callCache_.bt().topFnc();
+        Profiler::pushFrame(std::string(nameOf(*fnc)) + "()", /* isFnc */ true);
+    }
 }
 
 void SymExec::execFnc(
@@ -1113,6 +1170,16 @@ void SymExec::execFnc(
 
     // main loop
     while (!execStack_.empty()) {
+        if (memBudgetExceeded(params_.memBudget))
+            // drop the cached results of functions not being executed now
+            callCache_.trim();
+
+        if (spillBudgetExceeded(params_)) {
+            // the callers are suspended, so their states can go out of memory
+            BOOST_FOREACH(const ExecStackItem &item, execStack_)
+                item.eng->spillIdleStates();
+        }
+
         const ExecStackItem &item = execStack_.front();
         SymExecEngine *engine = item.eng;
 
@@ -1133,6 +1200,9 @@ void SymExec::execFnc(
             printMemUsage("SymExecEngine::~SymExecEngine");
             execStack_.pop_front();
 
+            if (Profiler::enabled())
+                Profiler::popFrame();
+
             if (!execStack_.empty() && forceEndReached)
                 // well, we got no results, but the callee suggests to be silent
                 execStack_.front().eng->forceEndReached();
@@ -1180,7 +1250,7 @@ void SymExec::execFnc(
 
 void SymExec::printStats() const
 {
-    // TODO: print SymCallCache stats here as soon as we have implemented some
+    callCache_.printStats();
 
     BOOST_FOREACH(const ExecStackItem &item, execStack_) {
         const IStatsProvider *provider = item.eng;
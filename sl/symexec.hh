@@ -40,13 +40,21 @@ struct SymExecParams {
     bool oomSimulation;     ///< enable/disable @b oom @b simulation mode
     bool skipPlot;          ///< simply ignore all ___sl_plot* calls
     bool ptrace;            ///< enable path tracing (a bit chatty)
+    size_t memBudget;       ///< if not zero, try to fit into this many bytes
+    size_t callCacheBudget; ///< if not zero, evict call cache beyond this size
+    size_t spillBudget;     ///< if not zero, spill idle states beyond this size
+    bool fncSummaries;      ///< reuse call results for covered entry heaps
     std::string errLabel;   ///< if not empty, treat reaching the label as error
 
     SymExecParams():
         trackUninit(false),
         oomSimulation(false),
         skipPlot(false),
-        ptrace(false)
+        ptrace(false),
+        memBudget(0U),
+        callCacheBudget(0U),
+        spillBudget(0U),
+        fncSummaries(false)
     {
     }
 };
@@ -22,6 +22,7 @@
 
 #include <cl/cl_msg.hh>
 
+#include "profiler.hh"
 #include "symheap.hh"
 #include "symplot.hh"
 #include "symseg.hh"
@@ -73,6 +74,7 @@ bool isJunk(SymHeap &sh, TValId root)
 
 bool gcCore(SymHeap &sh, TValId root, TValList *leakList, bool sharedOnly)
 {
+    ProfScope prof(PP_GC);
     CL_BREAK_IF(sh.valOffset(root));
     bool detected = false;
 
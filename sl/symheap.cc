@@ -43,6 +43,7 @@
 #include <algorithm>
 #include <map>
 #include <set>
+#include <vector>
 
 #include <boost/foreach.hpp>
 #include <boost/tuple/tuple.hpp>
@@ -123,51 +124,68 @@ class CVarMap {
         RefCounter refCnt;
 
     private:
-        typedef std::map<CVar, TValId>              TCont;
+        // kept sorted by CVar, i.e. instances of the same uid are adjacent
+        typedef std::pair<CVar, TValId>             TItem;
+        typedef std::vector<TItem>                  TCont;
         TCont                                       cont_;
 
+        struct LessByCVar {
+            bool operator()(const TItem &item, const CVar &cv) const {
+                return item.first < cv;
+            }
+        };
+
+        TCont::iterator lowerBound(const CVar &cv) {
+            return std::lower_bound(cont_.begin(), cont_.end(), cv,
+                    LessByCVar());
+        }
+
     public:
         void insert(CVar cVar, TValId val) {
+            const TCont::iterator iter = this->lowerBound(cVar);
+
             // check for mapping redefinition
-            CL_BREAK_IF(hasKey(cont_, cVar));
+            CL_BREAK_IF(cont_.end() != iter && cVar == iter->first);
 
             // define mapping
-            cont_[cVar] = val;
+            cont_.insert(iter, TItem(cVar, val));
         }
 
         void remove(CVar cVar) {
-            if (1 != cont_.erase(cVar))
+            const TCont::iterator iter = this->lowerBound(cVar);
+            if (cont_.end() == iter || cVar != iter->first) {
                 CL_BREAK_IF("offset detected in CVarMap::remove()");
+                return;
+            }
+
+            cont_.erase(iter);
         }
 
         TValId find(const CVar &cVar) {
-            // regular lookup
-            TCont::iterator iter = cont_.find(cVar);
-            const bool found = (cont_.end() != iter);
-            if (!cVar.inst) {
-                // gl variable explicitly requested
-                return (found)
-                    ? iter->second
-                    : VAL_INVALID;
-            }
-
-            // automatic fallback to gl variable
+            // the gl variable (inst == 0) precedes all lc instances of the uid
             CVar gl = cVar;
             gl.inst = /* global variable */ 0;
-            TCont::iterator iterGl = cont_.find(gl);
-            const bool foundGl = (cont_.end() != iterGl);
+            TCont::iterator iter = this->lowerBound(gl);
+
+            TValId addrGl = VAL_INVALID;
+            if (cont_.end() != iter && gl == iter->first) {
+                addrGl = iter->second;
+                ++iter;
+            }
+
+            if (!cVar.inst)
+                // gl variable explicitly requested
+                return addrGl;
 
-            if (!found && !foundGl)
-                // not found anywhere
-                return VAL_INVALID;
+            // look for the requested instance among the lc ones
+            iter = std::lower_bound(iter, cont_.end(), cVar, LessByCVar());
+            if (cont_.end() == iter || cVar != iter->first)
+                // automatic fallback to gl variable
+                return addrGl;
 
             // check for clash on uid among lc/gl variable
-            CL_BREAK_IF(found && foundGl);
-
-            if (found)
-                return iter->second;
-            else /* if (foundGl) */
-                return iterGl->second;
+            CL_BREAK_IF(VAL_INVALID != addrGl);
+            return iter->second;
         }
 };
 
@@ -2740,6 +2758,20 @@ IR::Range SymHeapCore::valOffsetRange(TValId val) const
     return range;
 }
 
+TValId SymHeapCore::valRangeAnchor(TOffset *pOff, TValId val) const
+{
+    const BaseValue *valData;
+    d->ents.getEntRO(&valData, val);
+    CL_BREAK_IF(VT_RANGE != valData->code);
+
+    const TValId anchor = valData->anchor;
+    *pOff = (anchor == val)
+        ? 0
+        : valData->offRoot;
+
+    return anchor;
+}
+
 void SymHeapCore::valReplace(TValId val, TValId replaceBy)
 {
     const BaseValue *valData;
@@ -2792,6 +2824,17 @@ void SymHeapCore::gatherRelatedValues(TValList &dst, TValId val) const
     d->coinDb->gatherRelatedValues(dst, val);
 }
 
+bool SymHeapCore::chkCoincidence(TValId *pSum, TValId v1, TValId v2) const
+{
+    return d->coinDb->chk(pSum, v1, v2);
+}
+
+void SymHeapCore::addCoincidence(TValId v1, TValId v2, TValId sum)
+{
+    RefCntLib<RCO_NON_VIRT>::requireExclusivity(d->coinDb);
+    d->coinDb->add(v1, v2, sum);
+}
+
 void SymHeapCore::copyRelevantPreds(SymHeapCore &dst, const TValMap &valMap)
     const
 {
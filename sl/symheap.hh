@@ -28,13 +28,14 @@
 
 #include "config.h"
 
+#include "idmap.hh"
 #include "intrange.hh"
 #include "symid.hh"
 #include "util.hh"
 
 #include <cl/code_listener.h>
 
-#include <map>              // for TValMap
+#include <map>
 #include <set>              // for TCVarSet
 #include <string>
 #include <vector>           // for many types
@@ -206,8 +207,8 @@ typedef std::vector<TValId>                             TValList;
 /// container used to store value IDs to
 typedef std::set<TValId>                                TValSet;
 
-/// a type used for (injective) value IDs mapping
-typedef std::map<TValId, TValId>                        TValMap;
+/// a type used for (injective) value IDs mapping, indexed by the value IDs
+typedef IdMap<TValId, TValId>                           TValMap;
 
 /// a type used for type-info
 typedef const struct cl_type                           *TObjType;
@@ -403,6 +404,12 @@ class SymHeapCore {
         /// collect values connect with the given value via an extra predicate
         void gatherRelatedValues(TValList &dst, TValId val) const;
 
+        /// true if v1 + v2 is known to be sum (v1 and v2 are range anchors)
+        bool chkCoincidence(TValId *pSum, TValId v1, TValId v2) const;
+
+        /// record that v1 + v2 is sum (v1 and v2 need to be range anchors)
+        void addCoincidence(TValId v1, TValId v2, TValId sum);
+
         /// transfer as many as possible extra heap predicates from this to dst
         void copyRelevantPreds(SymHeapCore &dst, const TValMap &valMap) const;
 
@@ -438,6 +445,9 @@ class SymHeapCore {
         /// return the offset range associated with the given VT_RANGE value
         IR::Range valOffsetRange(TValId) const;
 
+        /// return the anchor of a VT_RANGE value and the offset relative to it
+        TValId valRangeAnchor(TOffset *pOff, TValId val) const;
+
         /// narrow down the offset range of the given VT_RANGE value
         void valRestrictRange(TValId, IR::Range win);
 
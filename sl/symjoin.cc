@@ -23,8 +23,11 @@
 #include <cl/cl_msg.hh>
 #include <cl/cldebug.hh>
 #include <cl/clutil.hh>
+#include <cl/storage.hh>
 
+#include "profiler.hh"
 #include "prototype.hh"
+#include "symcapture.hh"
 #include "symcmp.hh"
 #include "symgc.hh"
 #include "symplot.hh"
@@ -35,9 +38,11 @@
 #include "worklist.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <iomanip>
 #include <map>
 #include <set>
+#include <vector>
 
 #include <boost/foreach.hpp>
 #include <boost/tuple/tuple.hpp>
@@ -86,14 +91,14 @@ namespace {
 }
 
 template <class T>
-class WorkListWithUndo: public WorkList<T> {
+class WorkListWithUndo: public WorkList<T, std::stack<T>, FlatSet<T> > {
     private:
-        typedef WorkList<T> TBase;
+        typedef WorkList<T, std::stack<T>, FlatSet<T> > TBase;
 
     public:
         /// push an @b already @b processed item back to WorkList
         void undo(const T &item) {
-            CL_BREAK_IF(!hasKey(TBase::seen_, item));
+            CL_BREAK_IF(!TBase::seen(item));
             TBase::todo_.push(item);
         }
 };
@@ -138,6 +143,22 @@ inline bool operator<(const SchedItem &a, const SchedItem &b)
     return (a.ldiff < b.ldiff);
 }
 
+// needed by FlatSet
+inline bool operator==(const SchedItem &a, const SchedItem &b)
+{
+    return (a.v1 == b.v1)
+        && (a.v2 == b.v2)
+        && (a.ldiff == b.ldiff);
+}
+
+template <>
+struct WorkListHash<SchedItem> {
+    size_t operator()(const SchedItem &item) const {
+        const size_t h = WorkListHash<TValPair>()(item);
+        return h ^ (static_cast<size_t>(item.ldiff) << 24);
+    }
+};
+
 typedef WorkListWithUndo<SchedItem>                             TWorkList;
 
 /// current state, common for joinSymHeaps(), joinDataReadOnly() and joinData()
@@ -160,11 +181,18 @@ struct SymJoinCtx {
     EJoinStatus                 status;
     bool                        allowThreeWay;
 
+    // true at loop-closing edges, see widenRange()
+    bool                        widen;
+
+    // used by checkEntailment() to give up as soon as sh1 does not cover sh2
+    bool                        entailmentOnly;
+    bool                        needJoin;
+
     typedef std::map<TValId /* seg */, TMinLen /* len */>       TSegLengths;
     TSegLengths                 segLengths;
 
-    std::set<TValPair>          tieBreaking;
-    std::set<TValPair>          alreadyJoined;
+    FlatSet<TValPair>           tieBreaking;
+    FlatSet<TValPair>           alreadyJoined;
 
     std::set<TValId /* dst */>  protoRoots;
 
@@ -187,7 +215,10 @@ struct SymJoinCtx {
         sh1(sh1_),
         sh2(sh2_),
         status(JS_USE_ANY),
-        allowThreeWay((1 < (SE_ALLOW_THREE_WAY_JOIN)) && allowThreeWay_)
+        allowThreeWay((1 < (SE_ALLOW_THREE_WAY_JOIN)) && allowThreeWay_),
+        widen(false),
+        entailmentOnly(false),
+        needJoin(false)
     {
         initValMaps();
     }
@@ -198,7 +229,10 @@ struct SymJoinCtx {
         sh1(sh_),
         sh2(sh_),
         status(JS_USE_ANY),
-        allowThreeWay(0 < (SE_ALLOW_THREE_WAY_JOIN))
+        allowThreeWay(0 < (SE_ALLOW_THREE_WAY_JOIN)),
+        widen(false),
+        entailmentOnly(false),
+        needJoin(false)
     {
         initValMaps();
     }
@@ -209,7 +243,10 @@ struct SymJoinCtx {
         sh1(sh_),
         sh2(sh_),
         status(JS_USE_ANY),
-        allowThreeWay(0 < (SE_ALLOW_THREE_WAY_JOIN))
+        allowThreeWay(0 < (SE_ALLOW_THREE_WAY_JOIN)),
+        widen(false),
+        entailmentOnly(false),
+        needJoin(false)
     {
         initValMaps();
     }
@@ -281,6 +318,12 @@ bool updateJoinStatus(SymJoinCtx &ctx, const EJoinStatus action)
     if (JS_USE_ANY == action)
         return true;
 
+    if (ctx.entailmentOnly && JS_USE_SH1 != action) {
+        // sh1 does not cover sh2, only a real join may help now
+        ctx.needJoin = true;
+        return false;
+    }
+
     EJoinStatus &status = ctx.status;
     switch (status) {
         case JS_THREE_WAY:
@@ -1336,6 +1379,43 @@ bool joinReturnAddrs(SymJoinCtx &ctx)
     return traverseRoots(ctx, VAL_ADDR_OF_RET, rootItem);
 }
 
+/// sorted integral constants of the program (see findIntThresholds())
+typedef std::vector<IR::TInt>                       TThresholds;
+
+/**
+ * widening with thresholds, rng1 comes from the state that is already there,
+ * rng2 from the one reaching the loop-closing edge.  A bound that is moving
+ * jumps to the nearest threshold beyond it (or to IntMin/IntMax if there is
+ * none), so that a loop counter converges in as many iterations as there are
+ * constants in the program, rather than one iteration per value.
+ */
+void widenRange(
+        IR::Range               *pRng,
+        const IR::Range         &rng1,
+        const IR::Range         &rng2,
+        const TThresholds       &thr)
+{
+    IR::Range &rng = *pRng;
+
+#if (SE_ALLOW_INT_RANGES & 0x2)
+    if (rng1.hi < rng2.hi) {
+        const TThresholds::const_iterator it =
+            std::lower_bound(thr.begin(), thr.end(), rng.hi);
+
+        rng.hi = (thr.end() == it) ? IR::IntMax : *it;
+    }
+#endif
+
+#if (SE_ALLOW_INT_RANGES & 0x4)
+    if (rng2.lo < rng1.lo) {
+        TThresholds::const_iterator it =
+            std::upper_bound(thr.begin(), thr.end(), rng.lo);
+
+        rng.lo = (thr.begin() == it) ? IR::IntMin : *(--it);
+    }
+#endif
+}
+
 bool joinCustomValues(
         SymJoinCtx              &ctx,
         const TValId            v1,
@@ -1374,17 +1454,24 @@ bool joinCustomValues(
     }
 #endif
 
+    if (ctx.widen) {
+        // we are closing a loop, jump to the nearest program constant (this
+        // creates a CV_INT_RANGE value even from two CV_INT values, otherwise
+        // a counting loop would end up with an unknown value)
+        widenRange(&rng, rng1, rng2, ctx.dst.stor().intThresholds);
+        SJ_DEBUG("--- widening " << SJ_VALP(v1, v2) << " to ["
+                << rng.lo << ", " << rng.hi << "]");
+    }
 #if !(SE_ALLOW_INT_RANGES & 0x1)
-    // avoid creation of a CV_INT_RANGE value from two CV_INT values
-    if (isSingular(rng1) && isSingular(rng2)) {
+    else if (isSingular(rng1) && isSingular(rng2)) {
+        // avoid creation of a CV_INT_RANGE value from two CV_INT values
         const TValId vDst = ctx.dst.valCreate(VT_UNKNOWN, VO_UNKNOWN);
         return updateJoinStatus(ctx, JS_THREE_WAY)
             && defineValueMapping(ctx, v1, v2, vDst);
     }
 #endif
-
-    // [experimental] widening on intervals
-    if (!isSingular(rng1) && !isSingular(rng2)) {
+    else if (!isSingular(rng1) && !isSingular(rng2)) {
+        // [experimental] widening on intervals
 #if (SE_ALLOW_INT_RANGES & 0x2)
         if (rng.lo == rng1.lo || rng.lo == rng2.lo)
             rng.hi = IR::IntMax;
@@ -2659,57 +2746,102 @@ bool validateStatus(const SymJoinCtx &ctx)
     return false;
 }
 
-bool joinSymHeaps(
-        EJoinStatus             *pStatus,
-        SymHeap                 *pDst,
-        SymHeap                  sh1,
-        SymHeap                  sh2,
-        const bool               allowThreeWay)
+bool joinSymHeapsCore(SymJoinCtx &ctx)
 {
-    SJ_DEBUG("--> joinSymHeaps()");
-    TStorRef stor = sh1.stor();
-    CL_BREAK_IF(&stor != &sh2.stor());
-
-    // update trace
-    Trace::waiveCloneOperation(sh1);
-    Trace::waiveCloneOperation(sh2);
-    *pDst = SymHeap(stor, new Trace::TransientNode("joinSymHeaps()"));
-
-    // initialize symbolic join ctx
-    SymJoinCtx ctx(*pDst, sh1, sh2, allowThreeWay);
-
     CL_BREAK_IF(!protoCheckConsistency(ctx.sh1));
     CL_BREAK_IF(!protoCheckConsistency(ctx.sh2));
 
     // first try to join return addresses (if in use)
     if (!joinReturnAddrs(ctx))
-        goto fail;
+        return false;
 
     // start with program variables
     if (!joinCVars(ctx, JoinVarVisitor::JVM_LIVE_OBJS))
-        goto fail;
+        return false;
 
     // go through all values in them
     if (!joinPendingValues(ctx))
-        goto fail;
+        return false;
 
     // time to preserve all 'hasValue' edges
     if (!setDstValues(ctx))
-        goto fail;
+        return false;
 
     // join uniform blocks
     if (!joinCVars(ctx, JoinVarVisitor::JVM_UNI_BLOCKS))
-        goto fail;
+        return false;
 
-    if (!updateMayExistLevels(ctx))
-        goto fail;
+    // the levels of prototypes affect only the resulting heap
+    if (!ctx.entailmentOnly && !updateMayExistLevels(ctx))
+        return false;
 
     // go through shared Neq predicates and set minimal segment lengths
     if (!handleDstPreds(ctx))
-        goto fail;
+        return false;
 
     // if the result is three-way join, check if it is a good idea
-    if (!validateStatus(ctx))
+    return validateStatus(ctx);
+}
+
+bool checkEntailment(
+        EJoinStatus             *pStatus,
+        bool                    *pNeedJoin,
+        const SymHeap           &sh1,
+        const SymHeap           &sh2)
+{
+    ProfScope prof(PP_JOIN);
+    SJ_DEBUG("--> checkEntailment()");
+    TStorRef stor = sh1.stor();
+    CL_BREAK_IF(&stor != &sh2.stor());
+
+    // the input heaps are only read, so we can safely avoid cloning them
+    SymHeap &sh1Writable = const_cast<SymHeap &>(sh1);
+    SymHeap &sh2Writable = const_cast<SymHeap &>(sh2);
+
+    // we still need a scratch heap to check the consistency of the mapping
+    SymHeap dst(stor, new Trace::TransientNode("checkEntailment()"));
+
+    SymJoinCtx ctx(dst, sh1Writable, sh2Writable, /* allowThreeWay */ false);
+    ctx.entailmentOnly = true;
+
+    // some callers of updateJoinStatus() ignore its return value, so a step
+    // that needs sh1 generalized does not necessarily fail joinSymHeapsCore()
+    const bool covered = joinSymHeapsCore(ctx) && !ctx.needJoin;
+    *pNeedJoin = ctx.needJoin;
+    if (!covered) {
+        SJ_DEBUG("<-- checkEntailment() gives up, needJoin = " << ctx.needJoin);
+        return false;
+    }
+
+    CL_BREAK_IF(JS_USE_ANY != ctx.status && JS_USE_SH1 != ctx.status);
+    *pStatus = ctx.status;
+    SJ_DEBUG("<-- checkEntailment() says " << ctx.status);
+    return true;
+}
+
+bool joinSymHeaps(
+        EJoinStatus             *pStatus,
+        SymHeap                 *pDst,
+        SymHeap                  sh1,
+        SymHeap                  sh2,
+        const bool               allowThreeWay,
+        const bool               widen)
+{
+    ProfScope prof(PP_JOIN);
+    CaptureScope cap(CO_JOIN, sh1, &sh2, allowThreeWay | (widen << 1));
+    SJ_DEBUG("--> joinSymHeaps()");
+    TStorRef stor = sh1.stor();
+    CL_BREAK_IF(&stor != &sh2.stor());
+
+    // update trace
+    Trace::waiveCloneOperation(sh1);
+    Trace::waiveCloneOperation(sh2);
+    *pDst = SymHeap(stor, new Trace::TransientNode("joinSymHeaps()"));
+
+    // initialize symbolic join ctx
+    SymJoinCtx ctx(*pDst, sh1, sh2, allowThreeWay);
+    ctx.widen = widen;
+    if (!joinSymHeapsCore(ctx))
         goto fail;
 
     if (debuggingSymJoin) {
@@ -2728,6 +2860,7 @@ bool joinSymHeaps(
 
     // all OK
     *pStatus = ctx.status;
+    cap.setOutcome(ctx.status);
     SJ_DEBUG("<-- joinSymHeaps() says " << ctx.status);
     CL_BREAK_IF(!dlSegCheckConsistency(ctx.dst));
     CL_BREAK_IF(!protoCheckConsistency(ctx.dst));
@@ -66,13 +66,36 @@ void joinData(
         const TValId            src,
         const bool              bidir);
 
-/// @todo some dox
+/**
+ * join two symbolic heaps into a single one that covers both of them
+ * @param allowThreeWay if false, give up instead of generalizing both heaps
+ * @param widen apply widening with thresholds on integral ranges, which is
+ * only sound to do at loop-closing edges, sh1 is the heap already there and
+ * sh2 the one coming along the edge
+ */
 bool joinSymHeaps(
         EJoinStatus             *pStatus,
         SymHeap                 *dst,
         SymHeap                  sh1,
         SymHeap                  sh2,
-        const bool               allowThreeWay = true);
+        const bool               allowThreeWay = true,
+        const bool               widen         = false);
+
+/**
+ * read-only variant of joinSymHeaps(), which only checks whether sh1 covers
+ * sh2, i.e. whether joinSymHeaps() would say JS_USE_ANY or JS_USE_SH1.  The
+ * input heaps are not copied and the check is cancelled as soon as it turns
+ * out that sh1 would need to be generalized.
+ * @param pStatus JS_USE_ANY or JS_USE_SH1 is stored there on success
+ * @param pNeedJoin on failure, true is stored there if joinSymHeaps() may
+ * still succeed with a generalization, false if it is known to fail
+ * @return true if sh1 covers sh2
+ */
+bool checkEntailment(
+        EJoinStatus             *pStatus,
+        bool                    *pNeedJoin,
+        const SymHeap           &sh1,
+        const SymHeap           &sh2);
 
 /// enable/disable debugging of symjoin
 void debugSymJoin(const bool enable);
@@ -25,6 +25,7 @@
 #include <cl/storage.hh>
 
 #include "plotenum.hh"
+#include "profiler.hh"
 #include "symheap.hh"
 #include "sympred.hh"
 #include "symseg.hh"
@@ -1398,6 +1399,26 @@ void plotEverything(PlotData &plot)
 #endif
 }
 
+// /////////////////////////////////////////////////////////////////////////////
+// limited count of plots
+struct PlotLimit {
+    unsigned                            limit;
+    unsigned                            cntPlots;
+
+    PlotLimit():
+        limit(0U),
+        cntPlots(0U)
+    {
+    }
+};
+
+static PlotLimit plotLimit;
+
+void setPlotLimit(const unsigned limit)
+{
+    ::plotLimit.limit = limit;
+}
+
 bool plotHeap(
         const SymHeap                   &sh,
         const std::string               &name,
@@ -1405,6 +1426,18 @@ bool plotHeap(
         const TValList                  &startingPoints,
         const bool                      digForward)
 {
+    PlotLimit &pl = ::plotLimit;
+    if (pl.limit && pl.limit <= pl.cntPlots) {
+        if (pl.limit == pl.cntPlots++)
+            CL_NOTE("plot limit reached, further heap graphs are skipped");
+
+        CL_DEBUG("skipping heap graph '" << name << "'");
+        return true;
+    }
+
+    ++pl.cntPlots;
+
+    ProfScope prof(PP_PLOT);
     PlotEnumerator *pe = PlotEnumerator::instance();
     std::string plotName(pe->decorate(name));
     std::string fileName(plotName + ".dot");
@@ -44,4 +44,7 @@ bool plotHeap(
         const TValList                  &startingPoints,
         const bool                      digForward = true);
 
+/// plot at most the given count of heaps, skip the rest (0 means unlimited)
+void setPlotLimit(unsigned limit);
+
 #endif /* H_GUARD_SYM_PLOT_H */
@@ -30,6 +30,7 @@
 #include "symabstract.hh"
 #include "symbin.hh"
 #include "symbt.hh"
+#include "symdecode.hh"
 #include "symgc.hh"
 #include "symheap.hh"
 #include "symplot.hh"
@@ -402,8 +403,37 @@ TOffset offItem(const struct cl_accessor *ac)
     return clt->items[id].offset;
 }
 
+TValId SymProc::targetAtDecoded(const struct cl_operand &op)
+{
+    const DecodedOperand *dop = dec_->operandOf(op);
+    if (!dop)
+        // not an operand of the instruction, or no fast path for it
+        return VAL_INVALID;
+
+    const int nestLevel = bt_->countOccurrencesOfTopFnc();
+    TValId addr = this->varAt(CVar(dop->uid, nestLevel));
+    if (!dop->hasAccessor)
+        return addr;
+
+    if (dop->isDeref) {
+        // read the value inside the pointer
+        const PtrHandle ptr(sh_, addr);
+        addr = ptr.value();
+    }
+
+    // apply the offset
+    return sh_.valByOffset(addr, dop->off);
+}
+
 TValId SymProc::targetAt(const struct cl_operand &op)
 {
+    if (dec_) {
+        // use the pre-decoded operand if available
+        const TValId at = this->targetAtDecoded(op);
+        if (VAL_INVALID != at)
+            return at;
+    }
+
     // resolve program variable
     TValId addr = this->varAt(op);
     const struct cl_accessor *ac = op.accessor;
@@ -2304,6 +2334,10 @@ bool SymExecCore::execCore(
 
         case CL_INSN_CALL:
             // the symbin module is now fully responsible for handling built-ins
+            if (dec_ && dec_->insn == &insn && dec_->builtIn)
+                return execBuiltIn(dst, *this, insn, *dec_->builtIn,
+                                   dec_->builtInName);
+
             return handleBuiltIn(dst, *this, insn);
 
         default:
@@ -2342,6 +2376,7 @@ bool SymExecCore::concretizeLoop(
         SymHeap &sh = todo.front();
         SymExecCore slave(sh, bt_, ep_);
         slave.setLocation(lw_);
+        slave.dec_ = dec_;
 
 #ifndef NDEBUG
         bool hitLocal = false;
@@ -2440,3 +2475,23 @@ bool SymExecCore::exec(SymState &dst, const CodeStorage::Insn &insn)
     // handle dereferences
     return this->concretizeLoop(dst, insn, derefs);
 }
+
+bool SymExecCore::exec(SymState &dst, const DecodedInsn &dec)
+{
+    if (!dec.derefsKnown)
+        // indirect call, the callee needs to be resolved per heap
+        return this->exec(dst, *dec.insn);
+
+    const CodeStorage::Insn &insn = *dec.insn;
+    if (dec.staticCallee && !dec.builtIn)
+        // a real function call, this has to be handled by SymExec
+        return false;
+
+    dec_ = &dec;
+
+    if (dec.derefs.empty())
+        return this->execCore(dst, insn);
+
+    // handle dereferences
+    return this->concretizeLoop(dst, insn, dec.derefs);
+}
@@ -36,6 +36,7 @@
 
 class SymBackTrace;
 class SymState;
+struct DecodedInsn;
 
 struct CmpOpTraits {
     bool negative;
@@ -95,6 +96,7 @@ class SymProc {
             sh_(heap),
             bt_(bt),
             lw_(0),
+            dec_(0),
             errorDetected_(false)
         {
         }
@@ -148,6 +150,7 @@ class SymProc {
         TValId varAt(const CVar &cv);
         TValId varAt(const struct cl_operand &op);
         TValId targetAt(const struct cl_operand &op);
+        TValId targetAtDecoded(const struct cl_operand &op);
         virtual void varInit(TValId at);
         friend void initGlVar(SymHeap &sh, const CVar &cv);
 
@@ -160,6 +163,7 @@ class SymProc {
         SymHeap                     &sh_;
         const SymBackTrace          *bt_;
         const struct cl_loc         *lw_;
+        const DecodedInsn           *dec_;  ///< insn being executed (if any)
         bool                         errorDetected_;
 };
 
@@ -227,6 +231,9 @@ class SymExecCore: public SymProc {
          */
         bool exec(SymState &dst, const CodeStorage::Insn &insn);
 
+        /// exec() for an instruction pre-decoded by FncDecoder
+        bool exec(SymState &dst, const DecodedInsn &dec);
+
         void execStackAlloc(const struct cl_operand &opLhs, const TSizeRange &);
 
         void execStackRestore();
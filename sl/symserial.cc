@@ -0,0 +1,902 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "symserial.hh"
+
+#include <cl/cl_msg.hh>
+#include <cl/storage.hh>
+
+#include "symstate.hh"
+#include "symtrace.hh"
+#include "symutil.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <queue>
+
+#include <boost/foreach.hpp>
+
+/// magic bytes at the beginning of a file with serialized heaps
+static const char heapFileMagic[] = "SLHEAPS";
+
+/// version of the format, bump on any incompatible change of the layout
+#define SYMSERIAL_VERSION 2
+
+// kinds of root entities
+enum ERootKind {
+    RK_VAR = 0,             ///< program variable (CVar)
+    RK_RET,                 ///< VAL_ADDR_OF_RET
+    RK_HEAP,                ///< heap object (possibly abstract)
+    RK_ANON_STACK           ///< anonymous stack object (alloca)
+};
+
+// kinds of values in the value table
+enum EValKind {
+    VK_ROOT = 0,            ///< address of a root entity
+    VK_OFF,                 ///< address of root shifted by a scalar offset
+    VK_RANGE,               ///< address of root shifted by a range of offsets
+    VK_CUSTOM,              ///< custom value (integral range, fnc, ...)
+    VK_UNKNOWN              ///< unknown value (or a dangling root)
+};
+
+static int typeUid(const TObjType clt)
+{
+    return (clt)
+        ? clt->uid
+        : /* no type-info */ -1;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// serialization
+class HeapSerializer {
+    public:
+        HeapSerializer(std::string &dst, const SymHeap &sh):
+            w_(dst),
+            sh_(const_cast<SymHeap &>(sh))
+        {
+        }
+
+        void run();
+
+    private:
+        typedef std::map<TValId, unsigned>              TIndex;
+
+        ByteWriter              w_;
+        SymHeap                &sh_;
+
+        TValList                roots_;         ///< roots in canonical order
+        TIndex                  rootIndex_;
+        std::queue<TValId>      rootTodo_;
+
+        std::string             valBuf_;        ///< serialized value table
+        TValList                vals_;          ///< values in canonical order
+        TIndex                  valIndex_;
+
+        std::string             bodyBuf_;       ///< serialized contents
+
+        /// reference to a value: non-positive IDs as they are, idx + 1 else
+        long long valRef(const TValId val);
+
+        void enqueueRoot(const TValId root);
+        void writeRootMeta(ByteWriter &w, const TValId root);
+        void writeRootBody(ByteWriter &w, const TValId root);
+        void indexCoincidences();
+        void writePreds(ByteWriter &w);
+
+        typedef std::vector<long long>                  TRefList;
+        TRefList                coinRefs_;      ///< triples (v1, v2, sum)
+};
+
+void HeapSerializer::enqueueRoot(const TValId root)
+{
+    if (hasKey(rootIndex_, root))
+        return;
+
+    rootIndex_[root] = roots_.size();
+    roots_.push_back(root);
+    rootTodo_.push(root);
+}
+
+long long HeapSerializer::valRef(const TValId val)
+{
+    if (val <= 0)
+        // special values are fixed
+        return val;
+
+    const TIndex::const_iterator it = valIndex_.find(val);
+    if (valIndex_.end() != it)
+        return it->second + 1;
+
+    ByteWriter w(valBuf_);
+
+    const EValueTarget code = realValTarget(sh_, val);
+    const TValId root = sh_.valRoot(val);
+    if (VT_CUSTOM == code) {
+        const CustomValue &cv = sh_.valUnwrapCustom(val);
+        const ECustomValue cCode = cv.code();
+        w.putUInt(VK_CUSTOM);
+        w.putUInt(cCode);
+        switch (cCode) {
+            case CV_FNC:
+                w.putInt(cv.uid());
+                break;
+
+            case CV_INT_RANGE:
+                w.putRange(cv.rng());
+                break;
+
+            case CV_REAL: {
+                const double fpn = cv.fpn();
+                unsigned long long bits;
+                memcpy(&bits, &fpn, sizeof bits);
+                w.putUInt(bits);
+                break;
+            }
+
+            case CV_STRING:
+                w.putStr(cv.str());
+                break;
+
+            case CV_INVALID:
+                break;
+        }
+    }
+    else if (isPossibleToDeref(code) || VAL_NULL == root) {
+        // address of an object, or an offset from NULL
+        const long long rootRef = (VAL_NULL == root)
+            ? static_cast<long long>(VAL_NULL)
+            : (this->enqueueRoot(root), this->valRef(root));
+
+        TOffset off = 0;
+        const TValId anchor = (VT_RANGE == sh_.valTarget(val))
+            ? sh_.valRangeAnchor(&off, val)
+            : VAL_INVALID;
+
+        if (anchor == val) {
+            w.putUInt(VK_RANGE);
+            w.putInt(rootRef);
+            w.putRange(sh_.valOffsetRange(val));
+        }
+        else if (VAL_INVALID != anchor) {
+            // keep off-values bound to their anchor (coincidences use anchors)
+            const long long anchorRef = this->valRef(anchor);
+            w.putUInt(VK_OFF);
+            w.putInt(anchorRef);
+            w.putInt(off);
+        }
+        else if (root == val) {
+            w.putUInt(VK_ROOT);
+            w.putUInt(rootIndex_[root]);
+        }
+        else {
+            w.putUInt(VK_OFF);
+            w.putInt(rootRef);
+            w.putInt(sh_.valOffset(val));
+        }
+    }
+    else if (isGone(code) && root != val && VT_RANGE != sh_.valTarget(val)) {
+        // dangling pointers to the same object need to share their root
+        const long long rootRef = this->valRef(root);
+        w.putUInt(VK_OFF);
+        w.putInt(rootRef);
+        w.putInt(sh_.valOffset(val));
+    }
+    else {
+        // unknown value, or a dangling root
+        w.putUInt(VK_UNKNOWN);
+        w.putUInt(code);
+        w.putUInt(sh_.valOrigin(val));
+    }
+
+    // the root of an address is always indexed before the address itself
+    const unsigned idx = vals_.size();
+    valIndex_[val] = idx;
+    vals_.push_back(val);
+    return idx + 1;
+}
+
+void HeapSerializer::writeRootMeta(ByteWriter &w, const TValId root)
+{
+    const EValueTarget code = sh_.valTarget(root);
+    if (VAL_ADDR_OF_RET == root) {
+        w.putUInt(RK_RET);
+    }
+    else if (isProgramVar(code) && -1 != sh_.cVarByRoot(root).uid) {
+        const CVar cv = sh_.cVarByRoot(root);
+        w.putUInt(RK_VAR);
+        w.putInt(cv.uid);
+        w.putInt(cv.inst);
+    }
+    else {
+        w.putUInt((isProgramVar(code)) ? RK_ANON_STACK : RK_HEAP);
+        w.putRange(sh_.valSizeOfTarget(root));
+    }
+
+    w.putInt(typeUid(sh_.valLastKnownTypeOfTarget(root)));
+    w.putInt(sh_.valTargetProtoLevel(root));
+
+    const bool isAbs = isAbstract(code);
+    w.putUInt(isAbs);
+    if (!isAbs)
+        return;
+
+    const EObjKind kind = sh_.valTargetKind(root);
+    w.putUInt(kind);
+    if (OK_OBJ_OR_NULL != kind) {
+        const BindingOff &off = sh_.segBinding(root);
+        w.putInt(off.head);
+        w.putInt(off.next);
+        w.putInt(off.prev);
+    }
+
+    w.putInt(sh_.segMinLength(root));
+}
+
+// needed to get a canonical order of live objects
+struct ObjOrder {
+    const SymHeap &sh;
+
+    ObjOrder(const SymHeap &sh_): sh(sh_) { }
+
+    bool operator()(const ObjHandle &a, const ObjHandle &b) const {
+        const TOffset offA = sh.valOffset(a.placedAt());
+        const TOffset offB = sh.valOffset(b.placedAt());
+        if (offA != offB)
+            return (offA < offB);
+
+        return (typeUid(a.objType()) < typeUid(b.objType()));
+    }
+};
+
+void HeapSerializer::writeRootBody(ByteWriter &w, const TValId root)
+{
+    // uniform blocks (ordered by offset already)
+    TUniBlockMap bMap;
+    sh_.gatherUniformBlocks(bMap, root);
+    w.putUInt(bMap.size());
+    BOOST_FOREACH(TUniBlockMap::const_reference item, bMap) {
+        const UniformBlock &bl = item.second;
+        w.putInt(bl.off);
+        w.putInt(bl.size);
+        w.putInt(this->valRef(bl.tplValue));
+    }
+
+    // live objects
+    ObjList objs;
+    sh_.gatherLiveObjects(objs, root);
+    std::sort(objs.begin(), objs.end(), ObjOrder(sh_));
+    w.putUInt(objs.size());
+    BOOST_FOREACH(const ObjHandle &obj, objs) {
+        const TObjType clt = obj.objType();
+        w.putInt(sh_.valOffset(obj.placedAt()));
+        w.putInt(typeUid(clt));
+
+        const bool hasValue = !isComposite(clt, /* includingArray */ false);
+        w.putUInt(hasValue);
+        if (hasValue)
+            w.putInt(this->valRef(obj.value()));
+    }
+}
+
+void HeapSerializer::writePreds(ByteWriter &w)
+{
+    typedef std::pair<long long, long long> TRefPair;
+    std::vector<TRefPair> neqs;
+
+    for (unsigned i = 0U; i < vals_.size(); ++i) {
+        const TValId val = vals_[i];
+
+        TValList related;
+        sh_.gatherRelatedValues(related, val);
+        BOOST_FOREACH(const TValId peer, related) {
+            if (!sh_.chkNeq(val, peer))
+                // a coincidence, already indexed by indexCoincidences()
+                continue;
+
+            if (peer <= 0) {
+                neqs.push_back(TRefPair(peer, i + 1));
+                continue;
+            }
+
+            const TIndex::const_iterator it = valIndex_.find(peer);
+            if (valIndex_.end() == it || it->second <= i)
+                // not reachable, or already written
+                continue;
+
+            neqs.push_back(TRefPair(i + 1, it->second + 1));
+        }
+    }
+
+    w.putUInt(neqs.size());
+    BOOST_FOREACH(const TRefPair &neq, neqs) {
+        w.putInt(neq.first);
+        w.putInt(neq.second);
+    }
+
+    CL_BREAK_IF(coinRefs_.size() % 3);
+    w.putUInt(coinRefs_.size() / 3);
+    BOOST_FOREACH(const long long ref, coinRefs_)
+        w.putInt(ref);
+}
+
+void HeapSerializer::indexCoincidences()
+{
+    // vals_ may grow while we are going through it
+    for (unsigned i = 0U; i < vals_.size(); ++i) {
+        const TValId val = vals_[i];
+
+        TValList related;
+        sh_.gatherRelatedValues(related, val);
+        BOOST_FOREACH(const TValId peer, related) {
+            TValId sum;
+            if (!sh_.chkCoincidence(&sum, val, peer))
+                // a Neq predicate, written by writePreds()
+                continue;
+
+            const long long peerRef = this->valRef(peer);
+            if (peerRef <= i)
+                // already indexed from the other side
+                continue;
+
+            coinRefs_.push_back(i + 1);
+            coinRefs_.push_back(peerRef);
+            coinRefs_.push_back(this->valRef(sum));
+        }
+    }
+}
+
+void HeapSerializer::run()
+{
+    // start with program variables in a fixed order
+    TCVarList cVars;
+    gatherProgramVars(cVars, sh_);
+    std::sort(cVars.begin(), cVars.end());
+    BOOST_FOREACH(const CVar &cv, cVars)
+        this->enqueueRoot(sh_.addrOfVar(cv, /* createIfNeeded */ false));
+
+    if (sh_.valLastKnownTypeOfTarget(VAL_ADDR_OF_RET))
+        this->enqueueRoot(VAL_ADDR_OF_RET);
+
+    // then the rest of roots (unreachable from program variables)
+    TValList rest;
+    sh_.gatherRootObjects(rest, isPossibleToDeref);
+    std::sort(rest.begin(), rest.end());
+
+    ByteWriter body(bodyBuf_);
+    TValList::const_iterator restIt = rest.begin();
+    for (;;) {
+        if (rootTodo_.empty()) {
+            if (rest.end() == restIt)
+                break;
+
+            this->enqueueRoot(*restIt++);
+            continue;
+        }
+
+        const TValId root = rootTodo_.front();
+        rootTodo_.pop();
+
+        // make sure the address of the root itself is indexed
+        this->valRef(root);
+        this->writeRootBody(body, root);
+    }
+
+    // values reachable via coincidences only need to be indexed, too
+    this->indexCoincidences();
+    CL_BREAK_IF(!rootTodo_.empty());
+
+    // roots
+    w_.putUInt(roots_.size());
+    BOOST_FOREACH(const TValId root, roots_)
+        this->writeRootMeta(w_, root);
+
+    // values, contents of roots and predicates
+    w_.putUInt(vals_.size());
+    w_.putStr(valBuf_);
+    w_.putStr(bodyBuf_);
+    this->writePreds(w_);
+}
+
+void serializeHeap(std::string &dst, const SymHeap &sh)
+{
+    HeapSerializer hs(dst, sh);
+    hs.run();
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// deserialization
+class HeapDeserializer {
+    public:
+        HeapDeserializer(SymHeap &dst, const std::string &src):
+            sh_(dst),
+            stor_(dst.stor()),
+            r_(src)
+        {
+        }
+
+        bool run();
+
+    private:
+        SymHeap                &sh_;
+        TStorRef                stor_;
+        ByteReader              r_;
+
+        TValList                roots_;
+        TValList                vals_;
+
+        typedef std::map<TValId /* seg */, TMinLen>     TSegLengths;
+        TSegLengths             segLengths_;
+
+        bool typeByUid(TObjType *pDst, const long long uid) const;
+        bool valByRef(TValId *pDst, const long long ref) const;
+
+        bool readRoot();
+        bool readVal(ByteReader &r);
+        bool readRootBody(ByteReader &r, const TValId root);
+        bool readPreds();
+};
+
+bool HeapDeserializer::typeByUid(TObjType *pDst, const long long uid) const
+{
+    if (-1 == uid) {
+        // no type-info
+        *pDst = 0;
+        return true;
+    }
+
+    // never trust the uids read from a file
+    if (!stor_.types.has(uid))
+        return false;
+
+    *pDst = stor_.types[uid];
+    return true;
+}
+
+bool HeapDeserializer::valByRef(TValId *pDst, const long long ref) const
+{
+    if (ref <= 0) {
+        const TValId val = static_cast<TValId>(ref);
+        if (VAL_NULL != val && VAL_TRUE != val && VAL_INVALID != val)
+            // not a special value we could have written
+            return false;
+
+        *pDst = val;
+        return true;
+    }
+
+    if (vals_.size() < static_cast<unsigned long long>(ref))
+        return false;
+
+    *pDst = vals_[ref - 1];
+    return true;
+}
+
+bool HeapDeserializer::readRoot()
+{
+    TValId root = VAL_INVALID;
+    const unsigned long long kind = r_.getUInt();
+    switch (kind) {
+        case RK_RET:
+            root = VAL_ADDR_OF_RET;
+            break;
+
+        case RK_VAR: {
+            const int uid  = r_.getInt();
+            const int inst = r_.getInt();
+            if (!r_.ok() || !stor_.vars.has(uid))
+                return false;
+
+            root = sh_.addrOfVar(CVar(uid, inst), /* createIfNeeded */ true);
+            break;
+        }
+
+        case RK_HEAP:
+            root = sh_.heapAlloc(r_.getRange());
+            break;
+
+        case RK_ANON_STACK:
+            // the owning call instance is not known at this point
+            root = sh_.stackAlloc(r_.getRange(), CallInst(-1, -1));
+            break;
+
+        default:
+            return false;
+    }
+
+    TObjType clt;
+    const bool cltValid = this->typeByUid(&clt, r_.getInt());
+    const TProtoLevel protoLevel = r_.getInt();
+    const bool isAbs = r_.getUInt();
+    if (!r_.ok() || !cltValid)
+        return false;
+
+    if (clt)
+        sh_.valSetLastKnownTypeOfTarget(root, clt);
+
+    sh_.valTargetSetProtoLevel(root, protoLevel);
+    roots_.push_back(root);
+
+    if (!isAbs)
+        return true;
+
+    const unsigned long long kindNum = r_.getUInt();
+    if (OK_CONCRETE == kindNum || OK_SEE_THROUGH_2N < kindNum)
+        return false;
+
+    const EObjKind kind2 = static_cast<EObjKind>(kindNum);
+    BindingOff off(OK_OBJ_OR_NULL);
+    if (OK_OBJ_OR_NULL != kind2) {
+        off.head = r_.getInt();
+        off.next = r_.getInt();
+        off.prev = r_.getInt();
+    }
+
+    segLengths_[root] = r_.getInt();
+    if (!r_.ok() || RK_HEAP != kind)
+        return false;
+
+    sh_.valTargetSetAbstract(root, kind2, off);
+    return true;
+}
+
+bool HeapDeserializer::readVal(ByteReader &r)
+{
+    TValId val = VAL_INVALID;
+    TValId root;
+
+    switch (r.getUInt()) {
+        case VK_ROOT: {
+            const unsigned long long idx = r.getUInt();
+            if (roots_.size() <= idx)
+                return false;
+
+            val = roots_[idx];
+            break;
+        }
+
+        case VK_OFF: {
+            if (!this->valByRef(&root, r.getInt()))
+                return false;
+
+            const TOffset off = r.getInt();
+            if (0 < root && VT_CUSTOM == sh_.valTarget(root))
+                return false;
+
+            val = sh_.valByOffset(root, off);
+            break;
+        }
+
+        case VK_RANGE: {
+            if (!this->valByRef(&root, r.getInt()))
+                return false;
+
+            const IR::Range rng = r.getRange();
+            if (!r.ok())
+                return false;
+
+            if (VAL_NULL != root && !isPossibleToDeref(sh_.valTarget(root)))
+                return false;
+
+            val = sh_.valByRange(root, rng);
+            break;
+        }
+
+        case VK_CUSTOM:
+            switch (r.getUInt()) {
+                case CV_FNC: {
+                    const int uid = r.getInt();
+                    if (!r.ok() || !stor_.fncs.has(uid))
+                        return false;
+
+                    val = sh_.valWrapCustom(CustomValue(uid));
+                    break;
+                }
+
+                case CV_INT_RANGE:
+                    val = sh_.valWrapCustom(CustomValue(r.getRange()));
+                    break;
+
+                case CV_REAL: {
+                    const unsigned long long bits = r.getUInt();
+                    double fpn;
+                    memcpy(&fpn, &bits, sizeof fpn);
+                    val = sh_.valWrapCustom(CustomValue(fpn));
+                    break;
+                }
+
+                case CV_STRING:
+                    val = sh_.valWrapCustom(CustomValue(r.getStr().c_str()));
+                    break;
+
+                default:
+                    return false;
+            }
+            break;
+
+        case VK_UNKNOWN: {
+            EValueTarget code = static_cast<EValueTarget>(r.getUInt());
+            const unsigned long long originNum = r.getUInt();
+            if (VO_HEAP < originNum)
+                return false;
+
+            const EValueOrigin origin = static_cast<EValueOrigin>(originNum);
+            if (VT_DELETED != code && VT_LOST != code)
+                code = VT_UNKNOWN;
+
+            val = sh_.valCreate(code, origin);
+            break;
+        }
+
+        default:
+            return false;
+    }
+
+    if (!r.ok())
+        return false;
+
+    vals_.push_back(val);
+    return true;
+}
+
+bool HeapDeserializer::readRootBody(ByteReader &r, const TValId root)
+{
+    for (unsigned long long cnt = r.getUInt(); r.ok() && cnt; --cnt) {
+        const TOffset off = r.getInt();
+        const TSizeOf size = r.getInt();
+
+        TValId tpl;
+        if (!this->valByRef(&tpl, r.getInt()) || !r.ok())
+            return false;
+
+        const TValId addr = sh_.valByOffset(root, off);
+        sh_.writeUniformBlock(addr, tpl, size);
+    }
+
+    for (unsigned long long cnt = r.getUInt(); r.ok() && cnt; --cnt) {
+        const TOffset off = r.getInt();
+        TObjType clt;
+        const bool cltValid = this->typeByUid(&clt, r.getInt());
+        const bool hasValue = r.getUInt();
+        if (!r.ok() || !cltValid || !clt)
+            return false;
+
+        const TValId addr = sh_.valByOffset(root, off);
+        const ObjHandle obj(sh_, addr, clt);
+        if (!hasValue)
+            continue;
+
+        TValId val;
+        if (!this->valByRef(&val, r.getInt()) || !r.ok())
+            return false;
+
+        obj.setValue(val);
+    }
+
+    return r.ok();
+}
+
+bool HeapDeserializer::readPreds()
+{
+    for (unsigned long long cnt = r_.getUInt(); r_.ok() && cnt; --cnt) {
+        TValId v1, v2;
+        if (!this->valByRef(&v1, r_.getInt()))
+            return false;
+        if (!this->valByRef(&v2, r_.getInt()))
+            return false;
+
+        sh_.addNeq(v1, v2);
+    }
+
+    for (unsigned long long cnt = r_.getUInt(); r_.ok() && cnt; --cnt) {
+        TValId v1, v2, sum;
+        if (!this->valByRef(&v1, r_.getInt()))
+            return false;
+        if (!this->valByRef(&v2, r_.getInt()))
+            return false;
+        if (!this->valByRef(&sum, r_.getInt()))
+            return false;
+
+        TValId old;
+        if (v1 <= 0 || v2 <= 0 || sh_.chkCoincidence(&old, v1, v2))
+            return false;
+
+        sh_.addCoincidence(v1, v2, sum);
+    }
+
+    return r_.ok();
+}
+
+bool HeapDeserializer::run()
+{
+    // roots
+    for (unsigned long long cnt = r_.getUInt(); r_.ok() && cnt; --cnt)
+        if (!this->readRoot())
+            return false;
+
+    // values
+    const unsigned long long cntVals = r_.getUInt();
+    const std::string valBuf = r_.getStr();
+    ByteReader rv(valBuf);
+    for (unsigned long long i = 0ULL; r_.ok() && i < cntVals; ++i)
+        if (!this->readVal(rv))
+            return false;
+
+    // contents of roots (in the same order as the roots)
+    const std::string bodyBuf = r_.getStr();
+    ByteReader rb(bodyBuf);
+    BOOST_FOREACH(const TValId root, roots_)
+        if (!this->readRootBody(rb, root))
+            return false;
+
+    // predicates
+    if (!this->readPreds())
+        return false;
+
+    // finally restore minimal lengths of segments
+    BOOST_FOREACH(TSegLengths::const_reference item, segLengths_)
+        sh_.segSetMinLength(item.first, item.second);
+
+    return true;
+}
+
+bool deserializeHeap(SymHeap &dst, const std::string &src)
+{
+    HeapDeserializer hd(dst, src);
+    if (hd.run())
+        return true;
+
+    CL_ERROR("deserializeHeap() failed to load a corrupted heap");
+    return false;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// file I/O
+void writeFileHeader(
+        std::string                 &dst,
+        const char                  *magic,
+        const unsigned              version,
+        TStorRef                    stor)
+{
+    dst += magic;
+    dst += '\0';
+
+    ByteWriter w(dst);
+    w.putUInt(version);
+
+    // the contents can be reloaded only against the same code storage
+    w.putUInt(stor.types.size());
+    w.putUInt(stor.vars.size());
+    w.putUInt(stor.fncs.size());
+}
+
+bool stripFileHeader(
+        std::string                 &buf,
+        const char                  *magic,
+        const unsigned              version,
+        TStorRef                    stor)
+{
+    std::string expected;
+    writeFileHeader(expected, magic, version, stor);
+    if (buf.compare(0, expected.size(), expected))
+        return false;
+
+    buf.erase(0, expected.size());
+    return true;
+}
+
+static bool writeHeaps(
+        const std::string           &fileName,
+        const SymState              &heaps,
+        const bool                  append)
+{
+    std::string buf;
+    BOOST_FOREACH(const SymHeap *sh, heaps) {
+        if (buf.empty() && !append)
+            writeFileHeader(buf, heapFileMagic, SYMSERIAL_VERSION, sh->stor());
+
+        std::string blob;
+        serializeHeap(blob, *sh);
+
+        ByteWriter w(buf);
+        w.putStr(blob);
+    }
+
+    std::ios_base::openmode mode = std::ios::out | std::ios::binary;
+    mode |= (append) ? std::ios::app : std::ios::trunc;
+    std::fstream out(fileName.c_str(), mode);
+    if (append && !heaps.size())
+        return !!out;
+
+    if (append && 0 == out.tellp()) {
+        // the file has just been created, write the header first
+        std::string hdr;
+        writeFileHeader(hdr, heapFileMagic, SYMSERIAL_VERSION,
+                heaps[0].stor());
+        out << hdr;
+    }
+
+    out << buf;
+    out.close();
+    if (!out) {
+        CL_ERROR("error while writing file '" << fileName << "'");
+        return false;
+    }
+
+    return true;
+}
+
+bool saveHeapsToFile(const std::string &fileName, const SymState &heaps)
+{
+    return writeHeaps(fileName, heaps, /* append */ false);
+}
+
+bool appendHeapsToFile(const std::string &fileName, const SymState &heaps)
+{
+    return writeHeaps(fileName, heaps, /* append */ true);
+}
+
+bool loadHeapsFromFile(
+        SymState                    &dst,
+        TStorRef                    stor,
+        const std::string           &fileName)
+{
+    std::fstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!in) {
+        CL_ERROR("unable to open file '" << fileName << "'");
+        return false;
+    }
+
+    std::string buf((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+
+    if (buf.empty())
+        // saveHeapsToFile() with an empty list of heaps
+        return true;
+
+    if (!stripFileHeader(buf, heapFileMagic, SYMSERIAL_VERSION, stor)) {
+        CL_ERROR("'" << fileName << "' does not contain heaps "
+                "captured against this code storage");
+        return false;
+    }
+
+    ByteReader r(buf);
+    while (!r.atEnd()) {
+        const std::string blob = r.getStr();
+        if (!r.ok())
+            break;
+
+        Trace::Node *tr = new Trace::TransientNode("loadHeapsFromFile()");
+        SymHeap sh(stor, tr);
+        if (!deserializeHeap(sh, blob))
+            return false;
+
+        dst.insert(sh);
+    }
+
+    if (!r.ok()) {
+        CL_ERROR("'" << fileName << "' is truncated");
+        return false;
+    }
+
+    return true;
+}
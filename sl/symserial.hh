@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2012 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_SYMSERIAL_H
+#define H_GUARD_SYMSERIAL_H
+
+/**
+ * @file symserial.hh
+ * compact binary serialization of symbolic heaps and their reload
+ *
+ * The serialization goes through the public API of SymHeap only, so it does
+ * not depend on the actual IDs of heap entities.  Objects are enumerated from
+ * program variables in a fixed order, values are numbered as they are reached
+ * for the first time.  Hence two isomorphic heaps (up to garbage) serialize
+ * into the same sequence of bytes.  Types, variables and functions are stored
+ * by their uid, so a heap can be only reloaded against the same code storage.
+ */
+
+#include "symheap.hh"
+
+#include <string>
+
+class SymState;
+
+/// low-level encoder of the binary format (LEB128 varints, zig-zag for signed)
+class ByteWriter {
+    public:
+        ByteWriter(std::string &dst):
+            dst_(dst)
+        {
+        }
+
+        void putUInt(unsigned long long num) {
+            while (0x80 <= num) {
+                dst_ += static_cast<char>((num & 0x7f) | 0x80);
+                num >>= 7;
+            }
+
+            dst_ += static_cast<char>(num);
+        }
+
+        void putInt(long long num) {
+            const unsigned long long zz = (num < 0)
+                ? ((static_cast<unsigned long long>(~num) << 1) | 1ULL)
+                : (static_cast<unsigned long long>(num) << 1);
+
+            this->putUInt(zz);
+        }
+
+        void putRange(const IR::Range &rng) {
+            this->putInt(rng.lo);
+            this->putInt(rng.hi);
+            this->putInt(rng.alignment);
+        }
+
+        void putStr(const std::string &str) {
+            this->putUInt(str.size());
+            dst_ += str;
+        }
+
+    private:
+        std::string &dst_;
+};
+
+/// decoder of the data written by ByteWriter, ok() is false on malformed input
+class ByteReader {
+    public:
+        ByteReader(const std::string &src):
+            src_(src),
+            pos_(0),
+            ok_(true)
+        {
+        }
+
+        bool ok() const { return ok_; }
+
+        bool atEnd() const { return src_.size() <= pos_; }
+
+        unsigned long long getUInt() {
+            unsigned long long num = 0ULL;
+            for (unsigned shift = 0U; shift < 64U; shift += 7U) {
+                if (this->atEnd()) {
+                    ok_ = false;
+                    return 0ULL;
+                }
+
+                const unsigned char c = src_[pos_++];
+                num |= static_cast<unsigned long long>(c & 0x7f) << shift;
+                if (!(c & 0x80))
+                    return num;
+            }
+
+            ok_ = false;
+            return 0ULL;
+        }
+
+        long long getInt() {
+            const unsigned long long zz = this->getUInt();
+            return (zz & 1ULL)
+                ? ~static_cast<long long>(zz >> 1)
+                : static_cast<long long>(zz >> 1);
+        }
+
+        IR::Range getRange() {
+            IR::Range rng;
+            rng.lo          = this->getInt();
+            rng.hi          = this->getInt();
+            rng.alignment   = this->getInt();
+            return rng;
+        }
+
+        std::string getStr() {
+            const unsigned long long len = this->getUInt();
+            if (!ok_ || src_.size() - pos_ < len) {
+                ok_ = false;
+                return std::string();
+            }
+
+            const std::string str = src_.substr(pos_, len);
+            pos_ += len;
+            return str;
+        }
+
+    private:
+        const std::string  &src_;
+        size_t              pos_;
+        bool                ok_;
+};
+
+/**
+ * write a file header identifying the format and the code storage
+ * @param dst the header is appended to this buffer
+ * @param magic a zero-terminated magic string identifying the format
+ * @param version version of the format
+ * @param stor the code storage the contents of the file is bound to
+ */
+void writeFileHeader(
+        std::string                 &dst,
+        const char                  *magic,
+        unsigned                    version,
+        TStorRef                    stor);
+
+/**
+ * check and remove the header written by writeFileHeader() from a buffer
+ * @return true if the buffer starts with the header expected for the given
+ * format and code storage
+ */
+bool stripFileHeader(
+        std::string                 &buf,
+        const char                  *magic,
+        unsigned                    version,
+        TStorRef                    stor);
+
+/// serialize the given heap into a compact binary form (appended to dst)
+void serializeHeap(std::string &dst, const SymHeap &sh);
+
+/**
+ * rebuild the heap previously serialized by serializeHeap()
+ * @param dst an empty heap (bound to the code storage) to rebuild the heap in
+ * @param src the serialized form of the heap
+ * @return true on success, false if src is corrupted
+ */
+bool deserializeHeap(SymHeap &dst, const std::string &src);
+
+/**
+ * write the given list of heaps to a file (overwrites the file)
+ * @return true on success
+ */
+bool saveHeapsToFile(const std::string &fileName, const SymState &heaps);
+
+/**
+ * append the given heaps to a file written by saveHeapsToFile()
+ * @note the file is created if it does not exist yet
+ * @return true on success
+ */
+bool appendHeapsToFile(const std::string &fileName, const SymState &heaps);
+
+/**
+ * load heaps from a file written by saveHeapsToFile()/appendHeapsToFile()
+ * @param dst the loaded heaps are appended to this list
+ * @param stor the code storage the heaps were captured against
+ * @param fileName name of the file to read the heaps from
+ * @return true on success, false if the file is missing, corrupted, or
+ * belongs to another code storage
+ */
+bool loadHeapsFromFile(
+        SymState                    &dst,
+        TStorRef                    stor,
+        const std::string           &fileName);
+
+#endif /* H_GUARD_SYMSERIAL_H */
@@ -23,15 +23,18 @@
 #include <cl/cl_msg.hh>
 #include <cl/storage.hh>
 
+#include "memdebug.hh"
 #include "symcmp.hh"
 #include "symjoin.hh"
 #include "symplot.hh"
+#include "symserial.hh"
 #include "symutil.hh"
 #include "symtrace.hh"
 #include "util.hh"
 #include "worklist.hh"
 
 #include <algorithm>            // for std::copy_if
+#include <cstdio>
 #include <iomanip>
 #include <map>
 
@@ -179,7 +182,9 @@ void SymStateWithJoin::packState(unsigned idxNew, bool allowThreeWay)
 
         EJoinStatus     status;
         SymHeap         result(stor, new Trace::TransientNode("packState()"));
-        if (!joinSymHeaps(&status, &result, shOld, shNew, allowThreeWay)) {
+        if (!joinSymHeaps(&status, &result, shOld, shNew, allowThreeWay,
+                    /* widen */ allowThreeWay))
+        {
             ++idxOld;
             continue;
         }
@@ -238,7 +243,13 @@ bool SymStateWithJoin::insert(const SymHeap &shNew, bool allowThreeWay)
     ++::cntLookups;
     for(idx = 0; idx < cnt; ++idx) {
         const SymHeap &shOld = this->operator[](idx);
-        if (joinSymHeaps(&status, &result, shOld, shNew, allowThreeWay))
+        bool needJoin;
+        if (checkEntailment(&status, &needJoin, shOld, shNew))
+            // shOld covers shNew, no need to compute the join
+            break;
+
+        if (needJoin && joinSymHeaps(&status, &result, shOld, shNew,
+                    allowThreeWay, /* widen */ allowThreeWay))
             // join succeeded
             break;
     }
@@ -485,6 +496,27 @@ void SymStateMarked::swap(SymState &other)
     // wipe done
     done_.clear();
     done_.resize((cntPending_ = this->size()), false);
+    this->reaccount();
+}
+
+void SymStateMarked::account(const SymHeap &sh, int sign)
+{
+    const ssize_t cntBytes = sign * estimateHeapBytes(sh);
+    memAccount(MS_STATE_MAP, sign, cntBytes);
+    cntHeaps_ += sign;
+    cntBytes_ += cntBytes;
+}
+
+void SymStateMarked::reaccount()
+{
+    // forget what we have accounted so far
+    memAccount(MS_STATE_MAP, -cntHeaps_, -cntBytes_);
+    cntHeaps_ = 0;
+    cntBytes_ = 0;
+
+    // account the current contents
+    BOOST_FOREACH(const SymHeap *sh, *this)
+        this->account(*sh, /* sign */ 1);
 }
 
 void SymStateMarked::rotateExisting(const int idxA, const int idxB)
@@ -502,6 +534,22 @@ void SymStateMarked::rotateExisting(const int idxA, const int idxB)
 struct SymStateMap::Private {
     typedef BlockScheduler::TBlock      TBlock;
 
+    /// a heap moved to the spill file, the trace node is kept in memory
+    struct SpilledHeap {
+        long                            off;
+        size_t                          len;
+        Trace::NodeHandle               trace;
+
+        SpilledHeap(const long off_, const size_t len_, Trace::Node *node):
+            off(off_),
+            len(len_),
+            trace(node)
+        {
+        }
+    };
+
+    typedef std::vector<SpilledHeap>    TSpilled;
+
     struct BlockState {
         SymStateMarked                  state;
 
@@ -511,6 +559,9 @@ struct SymStateMap::Private {
 
         bool                            anyHit;
 
+        /// if not empty, the state has been spilled (all heaps were done)
+        TSpilled                        spilled;
+
         BlockState():
             inbound(XXX),
             anyHit(false)
@@ -518,9 +569,225 @@ struct SymStateMap::Private {
         }
     };
 
-    std::map<TBlock, BlockState>        cont;
+    typedef std::map<TBlock, BlockState> TCont;
+
+    TCont                               cont;
+    FILE                               *spillFile;
+    const CodeStorage::Storage         *stor;
+
+    /// bytes of the spill file that hold spilled heaps
+    size_t                              cntLive;
+
+    /// bytes of the spill file that are not needed anymore
+    size_t                              cntDead;
+
+    Private():
+        spillFile(0),
+        stor(0),
+        cntLive(0U),
+        cntDead(0U)
+    {
+    }
+
+    ~Private() {
+        if (spillFile)
+            fclose(spillFile);
+    }
+
+    BlockState& lookup(TBlock bb);
+    bool spill(BlockState &bs);
+    void reload(BlockState &bs);
+    bool compact();
+    void reclaim();
 };
 
+// we can safely spill only heaps that are fully reconstructed on reload
+static bool isSpillable(const SymHeap &sh)
+{
+    // anonymous stack objects would lose the call instance that owns them
+    TValList roots;
+    sh.gatherRootObjects(roots, isProgramVar);
+    BOOST_FOREACH(const TValId root, roots)
+        if (-1 == sh.cVarByRoot(root).uid)
+            return false;
+
+    return true;
+}
+
+#ifndef NDEBUG
+// the serialized form of a heap needs to be checked before we drop the heap
+static bool survivesReload(const SymHeap &sh, const std::string &blob)
+{
+    SymHeap reloaded(sh.stor(), new Trace::TransientNode("survivesReload()"));
+    return deserializeHeap(reloaded, blob)
+        && areEqual(sh, reloaded);
+}
+#endif
+
+bool SymStateMap::Private::spill(BlockState &bs)
+{
+    SymStateMarked &state = bs.state;
+    BOOST_FOREACH(const SymHeap *sh, state)
+        if (!isSpillable(*sh))
+            return false;
+
+    if (!this->spillFile) {
+        // the file is removed automatically once it is closed
+        this->spillFile = tmpfile();
+        if (!this->spillFile) {
+            CL_WARN("SymStateMap: unable to create a temporary file");
+            return false;
+        }
+    }
+
+    FILE *f = this->spillFile;
+    if (fseek(f, 0L, SEEK_END))
+        return false;
+
+    TSpilled spilled;
+    size_t cntBytes = 0U;
+    BOOST_FOREACH(const SymHeap *sh, state) {
+        std::string blob;
+        serializeHeap(blob, *sh);
+#ifndef NDEBUG
+        if (!survivesReload(*sh, blob)) {
+            // keep the state in memory rather than losing any information
+            CL_BREAK_IF("SymStateMap: serialization of a heap is not lossless");
+            this->cntDead += cntBytes;
+            return false;
+        }
+#endif
+        const long off = ftell(f);
+        if (off < 0L || blob.size() != fwrite(blob.data(), 1, blob.size(), f))
+        {
+            CL_WARN("SymStateMap: error while writing the temporary file");
+            this->cntDead += cntBytes;
+            return false;
+        }
+
+        spilled.push_back(SpilledHeap(off, blob.size(), sh->traceNode()));
+        cntBytes += blob.size();
+    }
+
+    this->cntLive += cntBytes;
+    this->stor = &state[0].stor();
+    bs.spilled.swap(spilled);
+    state.clear();
+    return true;
+}
+
+void SymStateMap::Private::reload(BlockState &bs)
+{
+    TSpilled spilled;
+    spilled.swap(bs.spilled);
+
+    FILE *f = this->spillFile;
+    SymStateMarked &state = bs.state;
+    CL_BREAK_IF(state.size());
+
+    unsigned cntLost = 0U;
+    BOOST_FOREACH(const SpilledHeap &item, spilled) {
+        // the record is not needed in the file anymore
+        this->cntLive -= item.len;
+        this->cntDead += item.len;
+
+        std::string blob(item.len, '\0');
+        if (fseek(f, item.off, SEEK_SET)
+                || item.len != fread(&blob[0], 1, item.len, f))
+        {
+            ++cntLost;
+            continue;
+        }
+
+        SymHeap sh(*this->stor, new Trace::TransientNode("SymStateMap"));
+        if (!deserializeHeap(sh, blob)) {
+            ++cntLost;
+            continue;
+        }
+
+        sh.traceUpdate(item.trace.node());
+
+        // all the spilled heaps had been processed already
+        const int idx = state.size();
+        state.insertNew(sh);
+        state.setDone(idx);
+    }
+
+    if (cntLost)
+        // the lost heaps have been processed already, so nothing is missed;
+        // we only may need to process some of them once again later on
+        CL_WARN("SymStateMap: failed to reload " << cntLost
+                << " heap(s) from the temporary file, dropping them");
+
+    this->reclaim();
+}
+
+// copy the spilled heaps to a fresh temporary file, dropping the reloaded ones
+bool SymStateMap::Private::compact()
+{
+    FILE *dst = tmpfile();
+    if (!dst)
+        return false;
+
+    // the new offsets are used only once all the heaps have been copied
+    std::vector<long> offs;
+    std::string blob;
+    BOOST_FOREACH(TCont::const_reference item, this->cont) {
+        BOOST_FOREACH(const SpilledHeap &sh, item.second.spilled) {
+            blob.resize(sh.len);
+            const long off = ftell(dst);
+            if (fseek(this->spillFile, sh.off, SEEK_SET)
+                    || sh.len != fread(&blob[0], 1, sh.len, this->spillFile)
+                    || off < 0L
+                    || sh.len != fwrite(blob.data(), 1, sh.len, dst))
+            {
+                fclose(dst);
+                return false;
+            }
+
+            offs.push_back(off);
+        }
+    }
+
+    unsigned idx = 0U;
+    BOOST_FOREACH(TCont::reference item, this->cont)
+        BOOST_FOREACH(SpilledHeap &sh, item.second.spilled)
+            sh.off = offs[idx++];
+
+    fclose(this->spillFile);
+    this->spillFile = dst;
+    this->cntDead = 0U;
+    return true;
+}
+
+// give the space occupied by reloaded heaps back to the file system
+void SymStateMap::Private::reclaim()
+{
+    if (!this->cntLive) {
+        // nothing is spilled, drop the file (a new one is created if needed)
+        fclose(this->spillFile);
+        this->spillFile = 0;
+        this->cntDead = 0U;
+        return;
+    }
+
+    if (this->cntDead < (SE_SPILL_COMPACT_THR) || this->cntDead < this->cntLive)
+        // not worth copying the spilled heaps yet
+        return;
+
+    if (!this->compact())
+        CL_WARN("SymStateMap: failed to compact the temporary file");
+}
+
+SymStateMap::Private::BlockState& SymStateMap::Private::lookup(TBlock bb)
+{
+    BlockState &bs = this->cont[bb];
+    if (!bs.spilled.empty())
+        this->reload(bs);
+
+    return bs;
+}
+
 // TODO: drop this!
 SymStateMap SymStateMap::Private::BlockState::XXX;
 
@@ -536,7 +803,7 @@ SymStateMap::~SymStateMap()
 
 SymStateMarked& SymStateMap::operator[](const CodeStorage::Block *bb)
 {
-    return d->cont[bb].state;
+    return d->lookup(bb).state;
 }
 
 bool SymStateMap::insert(
@@ -546,7 +813,7 @@ bool SymStateMap::insert(
         const bool                      allowThreeWay)
 {
     // look for the _target_ block
-    Private::BlockState &ref = d->cont[dst];
+    Private::BlockState &ref = d->lookup(dst);
     const unsigned size = ref.state.size();
 
     // insert the given symbolic heap
@@ -580,9 +847,40 @@ bool SymStateMap::anyReuseHappened(const CodeStorage::Block *bb) const
 
 int SymStateMap::cntPending(const CodeStorage::Block *bb) const
 {
+    // a spilled state has no pending heaps, so there is no need to reload it
     return d->cont[bb].state.cntPending();
 }
 
+unsigned SymStateMap::spillIdleStates(size_t budget, const TBlockSet &keep)
+{
+    typedef std::pair<ssize_t /* size */, Private::BlockState *> TItem;
+    std::vector<TItem> cands;
+
+    BOOST_FOREACH(Private::TCont::reference item, d->cont) {
+        Private::BlockState &bs = item.second;
+        const SymStateMarked &state = bs.state;
+        if (!state.size() || state.cntPending() || hasKey(keep, item.first))
+            continue;
+
+        cands.push_back(TItem(state.cntBytes_, &bs));
+    }
+
+    // spill the largest states first
+    std::sort(cands.rbegin(), cands.rend());
+
+    unsigned cnt = 0U;
+    BOOST_FOREACH(const TItem &item, cands) {
+        // spill a bit more than needed not to spill again after each block
+        if (memAccounted(MS_STATE_MAP) <= static_cast<ssize_t>(budget / 2U))
+            break;
+
+        if (d->spill(*item.second))
+            ++cnt;
+    }
+
+    return cnt;
+}
+
 void SymStateMap::gatherInboundEdges(TContBlock                  &dst,
                                      const CodeStorage::Block    *ofBlock)
     const
@@ -160,16 +160,23 @@ class SymStateWithJoin: public SymHeapUnion {
 class SymStateMarked: public SymStateWithJoin {
     public:
         SymStateMarked():
-            cntPending_(0)
+            cntPending_(0),
+            cntHeaps_(0),
+            cntBytes_(0)
         {
         }
 
+        virtual ~SymStateMarked() {
+            this->clear();
+        }
+
         /// import of SymState rewrites the base and invalidates all flags
         SymStateMarked& operator=(const SymState &huni) {
             static_cast<SymState &>(*this) = huni;
             done_.clear();
             done_.resize(huni.size(), false);
             cntPending_ = huni.size();
+            this->reaccount();
             return *this;
         }
 
@@ -177,6 +184,7 @@ class SymStateMarked: public SymStateWithJoin {
             SymStateWithJoin::clear();
             done_.clear();
             cntPending_ = 0;
+            this->reaccount();
         }
 
         /// @attention always reinitializes the markers
@@ -190,6 +198,7 @@ class SymStateMarked: public SymStateWithJoin {
     protected:
         virtual void insertNew(const SymHeap &sh) {
             SymStateWithJoin::insertNew(sh);
+            this->account(sh, /* sign */ 1);
 
             // schedule the just inserted SymHeap for processing
             done_.push_back(false);
@@ -197,6 +206,7 @@ class SymStateMarked: public SymStateWithJoin {
         }
 
         virtual void eraseExisting(int nth) {
+            this->account(this->operator[](nth), /* sign */ -1);
             SymStateWithJoin::eraseExisting(nth);
 
             if (!done_[nth])
@@ -206,7 +216,9 @@ class SymStateMarked: public SymStateWithJoin {
         }
 
         virtual void swapExisting(int nth, SymHeap &sh) {
+            this->account(this->operator[](nth), /* sign */ -1);
             SymStateWithJoin::swapExisting(nth, sh);
+            this->account(this->operator[](nth), /* sign */ 1);
 
             if (!done_.at(nth))
                 return;
@@ -236,10 +248,18 @@ class SymStateMarked: public SymStateWithJoin {
         }
 
     private:
+        /// keep the memory accounting of SymStateMap up to date
+        void account(const SymHeap &sh, int sign);
+
+        /// recompute the accounting after the whole state has been replaced
+        void reaccount();
+
         typedef std::vector<bool> TDone;
 
         TDone           done_;
         int             cntPending_;
+        int             cntHeaps_;
+        ssize_t         cntBytes_;
 };
 
 class IPendingCountProvider {
@@ -257,11 +277,13 @@ class IPendingCountProvider {
 class SymStateMap: public IPendingCountProvider {
     public:
         typedef std::vector<const CodeStorage::Block *>     TContBlock;
+        typedef std::set<const CodeStorage::Block *>        TBlockSet;
 
         SymStateMap();
         virtual ~SymStateMap();
 
         /// state lookup, basically equal to std::map semantic
+        /// @note a state spilled by spillIdleStates() is reloaded transparently
         SymStateMarked& operator[](const CodeStorage::Block *);
 
         /**
@@ -296,6 +318,16 @@ class SymStateMap: public IPendingCountProvider {
 
         virtual int cntPending(const CodeStorage::Block *) const;
 
+        /**
+         * move fully processed states of idle blocks to a temporary file in the
+         * serialized form, largest states first, as long as the estimated size
+         * of all SymStateMap objects exceeds a half of the given budget
+         * @param budget memory budget (in bytes) for MS_STATE_MAP
+         * @param keep blocks that are scheduled or just being processed
+         * @return count of blocks that have been spilled
+         */
+        unsigned spillIdleStates(size_t budget, const TBlockSet &keep);
+
     private:
         /// object copying is @b not allowed
         SymStateMap(const SymStateMap &);
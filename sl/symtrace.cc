@@ -24,6 +24,7 @@
 #include <cl/storage.hh>
 
 #include "plotenum.hh"
+#include "profiler.hh"
 #include "worklist.hh"
 
 #include <algorithm>
@@ -335,6 +336,7 @@ void plotTraceCore(TracePlotter &tplot)
 // FIXME: copy-pasted from symplot.cc
 bool plotTrace(const std::string &name, TWorkList &wl)
 {
+    ProfScope prof(PP_PLOT);
     PlotEnumerator *pe = PlotEnumerator::instance();
     std::string plotName(pe->decorate(name));
     std::string fileName(plotName + ".dot");
@@ -27,6 +27,7 @@
 
 #include "config.h"
 
+#include "memdebug.hh"              // needed for memAccount()
 #include "symbt.hh"                 // needed for EMsgLevel
 #include "symheap.hh"               // needed for EObjKind
 
@@ -93,13 +94,16 @@ class Node: public NodeBase {
 
     protected:
         /// this is an abstract class, its instantiation is @b not allowed
-        Node() { }
+        Node() {
+            memAccount(MS_TRACE_GRAPH, 1, sizeof(Node));
+        }
 
         /// constructor for nodes with exactly one parent
         Node(Node *ref):
             NodeBase(ref)
         {
             ref->notifyBirth(this);
+            memAccount(MS_TRACE_GRAPH, 1, sizeof(Node));
         }
 
         /// constructor for nodes with exactly two parents
@@ -109,6 +113,12 @@ class Node: public NodeBase {
             parents_.push_back(ref2);
             ref1->notifyBirth(this);
             ref2->notifyBirth(this);
+            memAccount(MS_TRACE_GRAPH, 1, sizeof(Node));
+        }
+
+        virtual ~Node() {
+            const ssize_t size = sizeof(Node);
+            memAccount(MS_TRACE_GRAPH, -1, -size);
         }
 
         /// serialize this node to the given plot (externally not much useful)
@@ -328,6 +328,13 @@ void initGlVar(SymHeap &sh, const CVar &cv)
     (void) proc.varAt(cv);
 }
 
+ssize_t estimateHeapBytes(const SymHeapCore &sh)
+{
+    // a pointer in EntStore plus an average-sized (possibly shared) entity
+    static const ssize_t bytesPerEnt = sizeof(void *) + 0x40;
+    return (1U + sh.lastId()) * bytesPerEnt;
+}
+
 bool /* anyChange */ redirectRefs(
         SymHeap                 &sh,
         const TValId            pointingFrom,
@@ -140,6 +140,9 @@ inline bool isVarAlive(SymHeap &sh, const CVar &cv)
 
 void initGlVar(SymHeap &sh, const CVar &cv);
 
+/// rough estimate of the memory footprint of the given heap (in bytes)
+ssize_t estimateHeapBytes(const SymHeapCore &sh);
+
 inline TValId nextRootObj(SymHeap &sh, TValId root, TOffset offNext)
 {
     CL_BREAK_IF(sh.valOffset(root));
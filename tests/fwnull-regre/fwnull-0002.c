@@ -0,0 +1,10 @@
+#include <stdlib.h>
+
+void test5(int c)
+{
+    int *p;
+    if (c)
+        p = NULL;
+
+    *p = 0;
+}
@@ -0,0 +1,9 @@
+#include <stdlib.h>
+
+void test6(int *p)
+{
+    if (p)
+        return;
+
+    *p = 0;
+}
@@ -0,0 +1,54 @@
+#include <stdlib.h>
+#include <verifier-builtins.h>
+
+struct item {
+    struct item *next;
+};
+
+int main()
+{
+    struct item *list = NULL;
+
+    // create SLS 1+
+    do {
+        struct item *item = malloc(sizeof *item);
+        if (!item)
+            abort();
+
+        item->next = list;
+        list = item;
+    }
+    while (___sl_get_nondet_int());
+
+    // SLS 0+ reaches the loop head that already holds SLS 1+
+    while (___sl_get_nondet_int()) {
+        if (!list)
+            ___sl_error("the list has become empty");
+
+        struct item *next = list->next;
+        free(list);
+        list = next;
+    }
+
+    while (list) {
+        struct item *next = list->next;
+        free(list);
+        list = next;
+    }
+
+    return 0;
+}
+
+/**
+ * @file test-0240.c
+ *
+ * @brief SLS 0+ is not entailed by SLS 1+
+ *
+ * - the heap with SLS 0+ arriving to the loop head needs to be
+ *   joined with the heap holding SLS 1+ there, it must not be
+ *   dropped as an already covered one
+ *
+ * @attention
+ * This description is automatically imported from tests/predator-regre/README.
+ * Any changes made to this comment will be thrown away on the next import.
+ */
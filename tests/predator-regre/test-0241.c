@@ -0,0 +1,31 @@
+#include <verifier-builtins.h>
+
+int main()
+{
+    int i = 0;
+
+    // count far beyond SE_INT_ARITHMETIC_LIMIT
+    while (i < 1000)
+        ++i;
+
+    if (1000 != i)
+        ___sl_error("the loop counter has lost its exit value");
+
+    return 0;
+}
+
+/**
+ * @file test-0241.c
+ *
+ * @brief widening of a loop counter with thresholds
+ *
+ * - the counter is widened to the program constants at the
+ *   loop-closing edge, instead of unrolling the loop or throwing
+ *   the value away
+ *
+ * - the exit value of the counter needs to be known precisely
+ *
+ * @attention
+ * This description is automatically imported from tests/predator-regre/README.
+ * Any changes made to this comment will be thrown away on the next import.
+ */